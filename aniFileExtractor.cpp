@@ -1,15 +1,98 @@
 // Inspired by https://github.com/Mastermindzh/Scripts/blob/master/c%2B%2B/ani2png.c
 
+#include <charconv>
+
 #include "aniFileExtractor.hpp"
+#include "aniFileWriter.hpp"
+#include "apngWriter.hpp"
+#include "extractionPipeline.hpp"
+#include "hexDump.hpp"
 #include "printFileInformation.hpp"
+#include "x11CursorWriter.hpp"
 
 int main(int argc, const char **argv)
 {
+    const auto printUsage = [] {
+        std::cout << "$ ani2png [--stats|--stats=json|--stats=json=JSON_OUTPUT_FILE] ...\n"
+                  << "$ ani2png [--threads=N] FILE.ani PNG_FILE_OUTPUT_DIR\n"
+                  << "$ ani2png xcursor FILE.ani X11_CURSOR_OUTPUT_FILE\n"
+                  << "$ ani2png [--quantize] apng FILE.ani APNG_OUTPUT_FILE\n"
+                  << "$ ani2png rewrite FILE.ani ANI_OUTPUT_FILE\n"
+                  << "$ ani2png create ANI_OUTPUT_FILE JIFFIES_PER_FRAME FRAME.{ico,cur,png}...\n"
+                  << "$ ani2png dump FILE [FOURCC|#CHUNK_INDEX|START-END]...\n"
+                  << "$ ani2png ani FILE.ani\n"
+                  << "$ ani2png ico FILE.ico\n"
+                  << "$ ani2png png FILE.png" << std::endl;
+    };
+
+    // Remove the flags from the arguments
+    std::string statisticsFlag {};
+    bool quantize = false;
+    // The worker threads of the extraction (one per CPU core, the scanner and main thread mostly wait)
+    std::size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+    std::vector<const char *> arguments {};
+    for (int i = 0; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--stats" || argument == "--stats=json" ||
+            (argument.starts_with("--stats=json=") && argument.size() > 13)) {
+            statisticsFlag = argument;
+        } else if (argument.starts_with("--stats")) {
+            std::cout << "> Invalid statistics flag '" << argument << "'" << std::endl;
+            printUsage();
+            return -1;
+        } else if (argument == "--quantize") {
+            quantize = true;
+        } else if (argument.starts_with("--threads=")) {
+            const auto value = argument.substr(10);
+            const auto [end, errorCode] = std::from_chars(value.data(), value.data() + value.size(), threadCount);
+            if (errorCode != std::errc() || end != value.data() + value.size() || threadCount == 0) {
+                std::cout << "> Invalid thread count '" << value << "' (expected a positive number)" << std::endl;
+                printUsage();
+                return -1;
+            }
+        } else {
+            arguments.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(arguments.size());
+    argv = arguments.data();
+    getStatistics().enabled = !statisticsFlag.empty();
+
     std::string filePathString;
     if (argc >= 1) {
         filePathString =  argv[1] ;
     }
-    if (argc == 3) {
+    if (argc == 4 && filePathString == "xcursor") {
+        // Convert the animation directly into a X11 cursor file
+        const auto aniFileInformation = readAniFileInformation(readBinaryFile(argv[2]));
+        const auto x11CursorData = convertAniToX11Cursor(aniFileInformation);
+        StatisticsScopedTimer timer(StatisticsPhase::FRAME_WRITE, x11CursorData.size());
+        writeBinaryFile(argv[3], x11CursorData);
+    } else if (argc == 4 && filePathString == "apng") {
+        // Convert the animation into a single animated PNG preview file
+        const auto aniFileInformation = readAniFileInformation(readBinaryFile(argv[2]));
+        const auto apngData = convertAniToApng(aniFileInformation, quantize);
+        StatisticsScopedTimer timer(StatisticsPhase::FRAME_WRITE, apngData.size());
+        writeBinaryFile(argv[3], apngData);
+    } else if (argc >= 3 && filePathString == "dump") {
+        // Print a hex dump of the whole file or of the selected chunks/ranges
+        const std::vector<std::string> selectors(argv + 3, argv + argc);
+        printHexDumpSelection(readBinaryFile(argv[2]), selectors);
+    } else if (argc == 4 && filePathString == "rewrite") {
+        // Read an animation and write it again (the result is the same if it uses the same chunk order)
+        writeBinaryFile(argv[3], createAniFile(readAniFileInformation(readBinaryFile(argv[2]))));
+    } else if (argc >= 5 && filePathString == "create") {
+        // Create an animation from a list of icon/cursor/png frames
+        AniFileInformation aniFileInformation {};
+        aniFileInformation.JifRate = static_cast<uint32_t>(std::stoul(argv[3]));
+        for (int i = 4; i < argc; i++) {
+            const std::filesystem::path framePath = argv[i];
+            const auto frameData = readBinaryFile(framePath);
+            aniFileInformation.icons.push_back(framePath.extension() == ".png" ? createIcoFileFromPng(
+                                                   frameData) : frameData);
+        }
+        writeBinaryFile(argv[2], createAniFile(aniFileInformation));
+    } else if (argc == 3) {
         if (filePathString == "ani") {
             filePathString =  argv[2] ;
             printAniInformation(readBinaryFile(filePathString));
@@ -22,35 +105,21 @@ int main(int argc, const char **argv)
         } else {
             // Assume that the images and other information should be extracted
             // into a separate directory
-            const std::filesystem::path outDir = { argv[2] };
-            if (!std::filesystem::exists(outDir)) {
-                std::filesystem::create_directory(outDir);
-            }
-            std::filesystem::path filePath = filePathString;
-            std::filesystem::path imageOutputFilePathPrefix = outDir / filePathString;
-            if (filePath.has_extension()) {
-                imageOutputFilePathPrefix = outDir / filePath.stem();
-            }
-            const auto dataBytes = readBinaryFile(filePath);
-            const auto aniFileInformation = readAniFileInformation(dataBytes);
-            std::string x11cursorConfigTemplate {};
-            for (std::size_t iconCounter = 0; iconCounter < aniFileInformation.icons.size(); iconCounter++) {
-                const auto pngDataNew = aniFileInformation.icons.at(iconCounter);
-                const auto icoInformation = printIcoInformation(pngDataNew, 0);
-                writeBinaryFile(imageOutputFilePathPrefix.string() + "_" + std::to_string(iconCounter) + ".ico",
-                                pngDataNew);
-                x11cursorConfigTemplate.append(std::to_string(icoInformation.directoryHeaders.at(
-                                                   0).width) + " 2 4 " + filePath.stem().string() + "_" + std::to_string(
-                                                   iconCounter) + ".png TODO_MS\n");
-            }
-            writeTextFile(outDir / (filePath.stem().string() + "_template.cursor"), x11cursorConfigTemplate);
+            extractAniFile(filePathString, argv[2], threadCount);
         }
     } else {
-        std::cout << "$ ani2png FILE.ani PNG_FILE_OUTPUT_DIR\n"
-                  << "$ ani2png ani FILE.ani\n"
-                  << "$ ani2png ico FILE.ico\n"
-                  << "$ ani2png png FILE.png" << std::endl;
+        printUsage();
         return -1;
     }
+    if (statisticsFlag == "--stats") {
+        printStatistics(std::cout);
+    } else if (statisticsFlag == "--stats=json") {
+        // The standard output contains the debug output so the JSON object is written separately
+        printStatisticsJson(std::cerr);
+    } else if (statisticsFlag.starts_with("--stats=json=")) {
+        std::ostringstream json {};
+        printStatisticsJson(json);
+        writeTextFile(statisticsFlag.substr(13), json.str());
+    }
     return 0;
 }
@@ -2,22 +2,31 @@
 
 #pragma once
 
+#include <algorithm>
 #include <filesystem>
 #include <array>
 #include <vector>
 #include <cstdint>
 #include <optional>
 #include <fstream>
+#include <functional>
 #include <string>
 #include <cstring>
 #include <iostream>
 #include <sstream>
+#include <span>
+#include <stdexcept>
 #include <variant>
 
+#include "statistics.hpp"
+
 /**
- * Output debug comments
+ * Output debug comments (can be disabled at compile time with -DANI_FILE_EXTRACTOR_DEBUG=0)
  */
-constexpr bool debug = true;
+#ifndef ANI_FILE_EXTRACTOR_DEBUG
+#define ANI_FILE_EXTRACTOR_DEBUG 1
+#endif
+constexpr bool debug = ANI_FILE_EXTRACTOR_DEBUG;
 
 /**
  * @brief Read binary data from file to vector
@@ -30,6 +39,7 @@ std::vector<uint8_t> readBinaryFile(const std::filesystem::path &filePath)
         throw std::runtime_error("The file " + filePath.string() + " was not found");
     }
     const auto fileSize = std::filesystem::file_size(filePath);
+    StatisticsScopedTimer timer(StatisticsPhase::READ, fileSize);
     std::vector<uint8_t> buffer(fileSize);
     buffer.reserve(fileSize);
     std::ifstream binaryInputFile(filePath, std::ios::in | std::ios::binary);
@@ -44,26 +54,35 @@ std::vector<uint8_t> readBinaryFile(const std::filesystem::path &filePath)
     return buffer;
 }
 
+/**
+ * @brief Print the debug message that a file was written
+ * @param log The output stream of the debug messages
+ * @param filePath The filepath of the written file
+ * @param size The number of written bytes
+ */
+void logFileWritten(std::ostream &log, const std::filesystem::path &filePath, const std::size_t size)
+{
+    if constexpr(debug) {
+        log << "> " << filePath << " (size=" << size << ") was successfully written" << std::endl;
+    }
+}
+
 /**
  * @brief Write binary file from vector to file
  * @param filePath The filepath of the binary file to be written
- * @param data The vector that contains the binary data to be written
+ * @param data The vector (or view of a vector) that contains the binary data to be written
+ * @param log The output stream of the debug messages
  */
 void writeBinaryFile(const std::filesystem::path &filePath,
-                     const std::vector<uint8_t> &data)
+                     const std::span<const uint8_t> data, std::ostream &log = std::cout)
 {
     std::ofstream binaryOutputFile(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
     if (!binaryOutputFile.is_open()) {
         throw std::runtime_error("The file " + filePath.string() + " could not be opened");
     }
-    for (const auto &entry : data) {
-        binaryOutputFile.write(reinterpret_cast<const char *>(&entry), sizeof(char));
-    }
+    binaryOutputFile.write(reinterpret_cast<const char *>(data.data()), data.size());
     binaryOutputFile.close();
-    if constexpr(debug) {
-        std::cout << "> " << filePath << " (size=" << data.size() << ") was successfully written" <<
-                  std::endl;
-    }
+    logFileWritten(log, filePath, data.size());
 }
 
 /**
@@ -79,10 +98,22 @@ void writeTextFile(const std::filesystem::path &filePath, const std::string &dat
     }
     textOutputFile.write(data.c_str(), data.size());
     textOutputFile.close();
-    if constexpr(debug) {
-        std::cout << "> " << filePath << " (size=" << data.size() << ") was successfully written" <<
-                  std::endl;
+    logFileWritten(std::cout, filePath, data.size());
+}
+
+/**
+ * @brief Read a single byte with a bounds check (std::span has no at())
+ * @param data The binary data
+ * @param position The index of the byte
+ * @return The byte
+ */
+uint8_t readByte(const std::span<const uint8_t> data, const std::size_t position)
+{
+    if (position >= data.size()) {
+        throw std::out_of_range("Position " + std::to_string(position) + " is out of range (size=" +
+                                std::to_string(data.size()) + ")");
     }
+    return data[position];
 }
 
 /**
@@ -91,11 +122,11 @@ void writeTextFile(const std::filesystem::path &filePath, const std::string &dat
  * @param start The start index in the vector from which should be read
  * @return A 32 Bit unsigned number
  */
-uint32_t read32BitUnsignedIntegerLE(const std::vector<uint8_t> &data,
+uint32_t read32BitUnsignedIntegerLE(const std::span<const uint8_t> data,
                                     const std::size_t start)
 {
     uint32_t number;
-    std::array<uint8_t, 4> bytes { data.at(start), data.at(start + 1), data.at(start + 2), data.at(start + 3) };
+    std::array<uint8_t, 4> bytes { readByte(data, start), readByte(data, start + 1), readByte(data, start + 2), readByte(data, start + 3) };
     std::memcpy(&number, bytes.data(), sizeof(number));
     return number;
 }
@@ -106,15 +137,47 @@ uint32_t read32BitUnsignedIntegerLE(const std::vector<uint8_t> &data,
  * @param start The start index in the vector from which should be read
  * @return A 16 Bit unsigned number
  */
-uint16_t read16BitUnsignedIntegerLE(const std::vector<uint8_t> &data,
+uint16_t read16BitUnsignedIntegerLE(const std::span<const uint8_t> data,
                                     const std::size_t start)
 {
     uint16_t number;
-    std::array<uint8_t, 2> bytes { data.at(start), data.at(start + 1) };
+    std::array<uint8_t, 2> bytes { readByte(data, start), readByte(data, start + 1) };
     std::memcpy(&number, &bytes, sizeof(number));
     return number;
 }
 
+/**
+ * @brief Write a 32 Bit unsigned number as 4 little endian bytes (like a DWORD)
+ * @param data The vector in which the binary data should be written
+ * @param start The start index in the vector from which should be written
+ * @param number The 32 Bit unsigned number
+ */
+void write32BitUnsignedIntegerLE(std::vector<uint8_t> &data, const std::size_t start,
+                                 const uint32_t number)
+{
+    data.at(start) = static_cast<uint8_t>(number);
+    data.at(start + 1) = static_cast<uint8_t>(number >> 8);
+    data.at(start + 2) = static_cast<uint8_t>(number >> 16);
+    data.at(start + 3) = static_cast<uint8_t>(number >> 24);
+}
+
+/**
+ * @brief Read consecutive little endian 32 Bit unsigned numbers (like a DWORD array)
+ * @param data The vector that contains the binary data to be read
+ * @param start The start index in the vector from which should be read
+ * @param count The number of 32 Bit unsigned numbers that should be read
+ * @return A list of 32 Bit unsigned numbers
+ */
+std::vector<uint32_t> read32BitUnsignedIntegerLEList(const std::span<const uint8_t> data,
+        const std::size_t start, const std::size_t count)
+{
+    std::vector<uint32_t> numbers(count);
+    for (std::size_t i = 0; i < count; i++) {
+        numbers.at(i) = read32BitUnsignedIntegerLE(data, start + (i * 4));
+    }
+    return numbers;
+}
+
 /**
  * @brief Read bytes that represent a char string
  * @param data The vector that contains the binary data to be written
@@ -122,12 +185,12 @@ uint16_t read16BitUnsignedIntegerLE(const std::vector<uint8_t> &data,
  * @param length The number of bytes that should be read and the length of the resulting string
  * @return A char string
  */
-std::string readCharString(const std::vector<uint8_t> &data,
+std::string readCharString(const std::span<const uint8_t> data,
                            const std::size_t start, const std::size_t length)
 {
     std::string out(length, ' ');
     for (std::size_t i = 0; i < length; i++) {
-        out.at(i) = static_cast<char>(data.at(start + i));
+        out.at(i) = static_cast<char>(readByte(data, start + i));
     }
     return out;
 }
@@ -144,6 +207,10 @@ struct AniFileInformation {
     std::optional<std::string> art = {};
     /** If existing the content of the name tag */
     std::optional<std::string> name = {};
+    /** If existing the display rate of each animation step in jiffies (1/60th of a second) */
+    std::vector<uint32_t> rate = {};
+    /** If existing the icon index of each animation step */
+    std::vector<uint32_t> sequence = {};
     /** Num bytes in AniHeader (36 bytes) */
     uint32_t cbSizeOf;
     /** Number of unique Icons in this cursor */
@@ -168,6 +235,11 @@ struct AniFileInformation {
     std::string riffContainerType;
 };
 
+/**
+ * Callback that receives the index and the data of an icon of an `.ani` file
+ */
+using AniIconCallback = std::function<void(std::size_t, std::span<const uint8_t>)>;
+
 /**
  * RIFF/.ani file format:
  *
@@ -179,6 +251,7 @@ struct AniFileInformation {
  * "INAM" {4 Bytes=DWORD=length of title} {title data in chars} (the title of the icon)
  * "IART" {4 Bytes=DWORD=length of author} {author data in chars} (the author of the icon)
  * "fram" (TODO - not important?)
+ * "INFO" (list type of a "LIST" that contains the "INAM" and "IART" chunks)
  * "icon" {4 Bytes=DWORD=length of icon} {icon data} (TODO - IMPORTANT - WHAT IS THE DATA FORMAT???)
  * "anih" {4 Bytes=DWORD=length of ANI header (36 bytes)} {Data}
  *   > {4 Bytes=DWORD=cbSizeOf} (Number of unique Icons in this cursor)
@@ -190,8 +263,8 @@ struct AniFileInformation {
  *   > {4 Bytes=DWORD=cPlanes} (reserved, must be zero)
  *   > {4 Bytes=DWORD=JifRate} (Default Jiffies (1/60th of a second) if rate chunk not present)
  *   > {4 Bytes=DWORD=flags} (Animation Flag - TODO?)
- * "rate" {4 Bytes=DWORD=length of rate block} {Data} (TODO - not important?)
- * "seq " {4 Bytes=DWORD=length of sequence block} {Data} (TODO - not important?)
+ * "rate" {4 Bytes=DWORD=length of rate block} {cSteps DWORDs} (display rate of each step in jiffies)
+ * "seq " {4 Bytes=DWORD=length of sequence block} {cSteps DWORDs} (icon index of each step)
  *
  * Sources are https://www.gdgsoft.com/anituner/help/aniformat.htm which cites a post by R. James Houghtaling
  * and the website www.wotsit.org by Paul Oliver which is not accessible any more.
@@ -201,18 +274,28 @@ struct AniFileInformation {
  * animated and not animated icons it just checks if it is an animated icon and finds all icon blocks.
  * If there are multiple INAM/IART blocks or something similar this parser WILL FAIL!!!!!
  *
+ * If an icon callback is given every icon is passed as view into the data (with its index) as soon
+ * as it is found instead of being copied into the icon list.
+ *
  * @brief Read out all the information from a given `.ani` file binary data vector
  * @param data The `.ani` file binary data vector
+ * @param onIcon The optional icon callback (its time is not counted for the RIFF scan and the chunk)
+ * @param log The output stream of the debug messages
  * @return Information object that contains all read data
  */
-AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
+AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data,
+        const AniIconCallback &onIcon = {}, std::ostream &log = std::cout)
 {
+    StatisticsScopedTimer timer(StatisticsPhase::RIFF_SCAN, data.size());
     AniFileInformation aniFileInformation {};
+    std::size_t iconCount = 0;
+    // The position of the pad byte after the last chunk with an odd data length
+    std::size_t paddingPosition = 0;
     // Check for RIFF at the begin of the data
     if (8 <= data.size() && readCharString(data, 0, 4) == "RIFF") {
         aniFileInformation.riffDataLength = read32BitUnsignedIntegerLE(data, 4);
         if constexpr(debug) {
-            std::cout << "> RIFF header was found at " << 0 << std::endl;
+            log << "> RIFF header was found at " << 0 << std::endl;
         }
     } else {
         throw std::runtime_error(".ani data did not start with RIFF container name and length");
@@ -220,55 +303,82 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
     if (12 <= data.size() && readCharString(data, 8, 4) == "ACON") {
         aniFileInformation.riffContainerType = "ACON";
         if constexpr(debug) {
-            std::cout << "> Found RIFF field 'ACON' at " << 8 << std::endl;
+            log << "> Found RIFF field 'ACON' at " << 8 << std::endl;
         }
     } else {
         throw std::runtime_error(".ani data did not have the ACON field in the RIFF container");
     }
     for (std::size_t i = 12; i < data.size(); i ++) {
+        // Chunk data is padded to the nearest WORD boundary (only directly after odd-length data)
+        if (i == paddingPosition && data.at(i) == 0) {
+            continue;
+        }
         if (i + 8 <= data.size() && readCharString(data, i, 4) == "INAM") {
             auto length = read32BitUnsignedIntegerLE(data, i + 4);
+            StatisticsScopedTimer chunkTimer(StatisticsPhase::CHUNK_HANDLING, length);
+            countStatisticsChunk("INAM", length);
             if constexpr(debug) {
-                std::cout << "> Found RIFF field 'INAM' at " << i << " [length=" << length << ",data='";
+                log << "> Found RIFF field 'INAM' at " << i << " [length=" << length << ",data='";
             }
             i += 8;
-            if (i + length <= data.size()) {
+            if (length <= data.size() - i) {
                 aniFileInformation.name = readCharString(data, i, length);
                 i += length;
+                if (length % 2 == 1) {
+                    paddingPosition = i;
+                }
             } else {
                 throw std::runtime_error("Unexpected end of file while reading 'INAM' data");
             }
             if constexpr(debug) {
-                std::cout << aniFileInformation.name.value_or("ERROR: Was not read") << "']" << std::endl;
+                log << aniFileInformation.name.value_or("ERROR: Was not read") << "']" << std::endl;
             }
             i -= 1;
             continue;
         }
         if (i + 8 <= data.size() && readCharString(data, i, 4) == "IART") {
             auto length = read32BitUnsignedIntegerLE(data, i + 4);
+            StatisticsScopedTimer chunkTimer(StatisticsPhase::CHUNK_HANDLING, length);
+            countStatisticsChunk("IART", length);
             if constexpr(debug) {
-                std::cout << "> Found RIFF field 'IART' at " << i << " [length=" << length << ",data='";
+                log << "> Found RIFF field 'IART' at " << i << " [length=" << length << ",data='";
             }
             i += 8;
-            if (i + length <= data.size()) {
+            if (length <= data.size() - i) {
                 aniFileInformation.art = readCharString(data, i, length);
                 i += length;
+                if (length % 2 == 1) {
+                    paddingPosition = i;
+                }
             } else {
                 throw std::runtime_error("Unexpected end of file while reading 'IART' data");
             }
             if constexpr(debug) {
-                std::cout << aniFileInformation.art.value_or("ERROR: Was not read") << "']" << std::endl;
+                log << aniFileInformation.art.value_or("ERROR: Was not read") << "']" << std::endl;
             }
             i -= 1;
             continue;
         }
         if (i + 8 <= data.size() && readCharString(data, i, 4) == "icon") {
             auto length = read32BitUnsignedIntegerLE(data, i + 4);
+            StatisticsScopedTimer chunkTimer(StatisticsPhase::CHUNK_HANDLING, length);
+            countStatisticsChunk("icon", length);
             if constexpr(debug) {
-                std::cout << "> Found RIFF field 'icon' at " << i << " [length=" << length << "]" << std::endl;
+                log << "> Found RIFF field 'icon' at " << i << " [length=" << length << "]" << std::endl;
             }
             i += 8;
-            if (i + length <= data.size()) {
+            if (length <= data.size() - i && onIcon) {
+                {
+                    // The callback can wait for the next stage of the pipeline which is not part of the scan
+                    const StatisticsTimerPause pauseScanTimer(timer);
+                    const StatisticsTimerPause pauseChunkTimer(chunkTimer);
+                    onIcon(iconCount++, std::span<const uint8_t>(data).subspan(i, length));
+                }
+                i += length;
+                if (length % 2 == 1) {
+                    paddingPosition = i;
+                }
+            } else if (length <= data.size() - i) {
                 std::vector<uint8_t> iconData(length);
                 iconData.reserve(length);
                 for (std::size_t j = 0; j < length; j++) {
@@ -276,6 +386,9 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
                 }
                 aniFileInformation.icons.push_back(iconData);
                 i += length;
+                if (length % 2 == 1) {
+                    paddingPosition = i;
+                }
             } else {
                 throw std::runtime_error("Unexpected end of file while reading 'icon' data");
             }
@@ -284,17 +397,21 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
         }
         if (i + 8 <= data.size() && readCharString(data, i, 4) == "seq ") {
             auto length = read32BitUnsignedIntegerLE(data, i + 4);
+            StatisticsScopedTimer chunkTimer(StatisticsPhase::CHUNK_HANDLING, length);
+            countStatisticsChunk("seq ", length);
             if constexpr(debug) {
-                std::cout << "> Found RIFF field 'seq ' at " << i << " [length=" << length << "]" << std::endl;
+                log << "> Found RIFF field 'seq ' at " << i << " [length=" << length << "]" << std::endl;
             }
             i += 8;
-            if (i + length <= data.size()) {
-                auto seqContent = readCharString(data, i, length);
-                // TODO What is this
+            if (length <= data.size() - i) {
+                aniFileInformation.sequence = read32BitUnsignedIntegerLEList(data, i, length / 4);
                 if constexpr(debug) {
-                    std::cout << ">> 'seq ' content: '" << seqContent << "'" << std::endl;
+                    log << ">> 'seq ' content: " << aniFileInformation.sequence.size() << " steps" << std::endl;
                 }
                 i += length;
+                if (length % 2 == 1) {
+                    paddingPosition = i;
+                }
             } else {
                 throw std::runtime_error("Unexpected end of file while reading 'seq ' data");
             }
@@ -303,17 +420,21 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
         }
         if (i + 8 <= data.size() && readCharString(data, i, 4) == "rate") {
             auto length = read32BitUnsignedIntegerLE(data, i + 4);
+            StatisticsScopedTimer chunkTimer(StatisticsPhase::CHUNK_HANDLING, length);
+            countStatisticsChunk("rate", length);
             if constexpr(debug) {
-                std::cout << "> Found RIFF field 'rate' at " << i << " [length=" << length << "]" << std::endl;
+                log << "> Found RIFF field 'rate' at " << i << " [length=" << length << "]" << std::endl;
             }
             i += 8;
-            if (i + length <= data.size()) {
-                auto seqContent = readCharString(data, i, length);
-                // TODO What is this
+            if (length <= data.size() - i) {
+                aniFileInformation.rate = read32BitUnsignedIntegerLEList(data, i, length / 4);
                 if constexpr(debug) {
-                    std::cout << ">> 'rate' content: '" << seqContent << "'" << std::endl;
+                    log << ">> 'rate' content: " << aniFileInformation.rate.size() << " steps" << std::endl;
                 }
                 i += length;
+                if (length % 2 == 1) {
+                    paddingPosition = i;
+                }
             } else {
                 throw std::runtime_error("Unexpected end of file while reading 'rate' data");
             }
@@ -322,14 +443,16 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
         }
         if (i + 8 <= data.size() && readCharString(data, i, 4) == "anih") {
             auto length = read32BitUnsignedIntegerLE(data, i + 4);
+            StatisticsScopedTimer chunkTimer(StatisticsPhase::CHUNK_HANDLING, length);
+            countStatisticsChunk("anih", length);
             if constexpr(debug) {
-                std::cout << "> Found RIFF field 'anih' at " << i << " [length=" << length << "]" << std::endl;
+                log << "> Found RIFF field 'anih' at " << i << " [length=" << length << "]" << std::endl;
             }
             i += 8;
             if (length != 36) {
                 throw std::runtime_error("Unexpected length of 'anih' field " + std::to_string(length) + "!=36");
             }
-            if (i + length <= data.size()) {
+            if (length <= data.size() - i) {
                 aniFileInformation.cbSizeOf = read32BitUnsignedIntegerLE(data, i);
                 i += 4;
                 aniFileInformation.cFrames = read32BitUnsignedIntegerLE(data, i);
@@ -357,10 +480,11 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
         if (i + 8 <= data.size() && static_cast<char>(data.at(i)) == 'L' &&
             static_cast<char>(data.at(i + 1)) == 'I' && static_cast<char>(data.at(i + 2)) == 'S' &&
             static_cast<char>(data.at(i + 3)) == 'T') {
-            std::cout << "> Found 'LIST' at " << i;
+            log << "> Found 'LIST' at " << i;
             i += 4;
             auto length = read32BitUnsignedIntegerLE(data, i);
-            std::cout << " [length=" << length << "]" << std::endl;
+            log << " [length=" << length << "]" << std::endl;
+            countStatisticsChunk("LIST", length);
             i += 4;
             i -= 1;
             continue;
@@ -368,7 +492,17 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
         if (i + 4 <= data.size() && static_cast<char>(data.at(i)) == 'f' &&
             static_cast<char>(data.at(i + 1)) == 'r' && static_cast<char>(data.at(i + 2)) == 'a' &&
             static_cast<char>(data.at(i + 3)) == 'm') {
-            std::cout << "> Found 'fram' at " << i << std::endl;
+            log << "> Found 'fram' at " << i << std::endl;
+            countStatisticsChunk("fram", 0);
+            i += 4;
+            i -= 1;
+            continue;
+        }
+        if (i + 4 <= data.size() && readCharString(data, i, 4) == "INFO") {
+            if constexpr(debug) {
+                log << "> Found 'INFO' at " << i << std::endl;
+            }
+            countStatisticsChunk("INFO", 0);
             i += 4;
             i -= 1;
             continue;
@@ -379,6 +513,112 @@ AniFileInformation readAniFileInformation(const std::vector<uint8_t> &data)
     return aniFileInformation;
 }
 
+/**
+ * Position of a chunk in RIFF data
+ */
+struct RiffChunk {
+    /** The FOURCC that identifies the chunk */
+    std::string id;
+    /** The position of the chunk id */
+    std::size_t start;
+    /** The position of the chunk data */
+    std::size_t dataStart;
+    /** The chunk data length (clamped to the end of the data) */
+    std::size_t length;
+    /** The index of the top level chunk that contains (or is) this chunk */
+    std::size_t topLevelIndex;
+    /** The number of lists that contain this chunk (0 = top level chunk) */
+    std::size_t depth;
+};
+
+/**
+ * Walks over all chunks of a RIFF container including the chunks in 'LIST' chunks.
+ * The chunk numbering of the top level chunks is the same as in printAniInformation.
+ *
+ * @brief List all chunks of RIFF data
+ * @param data The RIFF binary data vector
+ * @return All found chunks in the order of their position
+ */
+std::vector<RiffChunk> listRiffChunks(const std::vector<uint8_t> &data)
+{
+    std::vector<RiffChunk> chunks {};
+    if (data.size() < 12 || readCharString(data, 0, 4) != "RIFF") {
+        return chunks;
+    }
+    const std::size_t end = std::min<std::size_t>(data.size(), 8 + static_cast<std::size_t>
+                            (read32BitUnsignedIntegerLE(data, 4)));
+    // Positions where the current list ends (the top level is the RIFF container)
+    std::vector<std::size_t> listEnds { end };
+    std::size_t topLevelCount = 0;
+    std::size_t i = 12;
+    while (i + 8 <= listEnds.back()) {
+        RiffChunk chunk {};
+        chunk.id = readCharString(data, i, 4);
+        chunk.start = i;
+        chunk.dataStart = i + 8;
+        chunk.length = std::min<std::size_t>(read32BitUnsignedIntegerLE(data, i + 4),
+                                             listEnds.back() - chunk.dataStart);
+        if (listEnds.size() == 1) {
+            topLevelCount++;
+        }
+        chunk.topLevelIndex = topLevelCount - 1;
+        chunk.depth = listEnds.size() - 1;
+        chunks.push_back(chunk);
+        const std::size_t chunkEnd = chunk.dataStart + chunk.length + (chunk.length % 2);
+        if (chunk.id == "LIST" && chunk.length >= 4) {
+            // Continue with the sub chunks after the list type
+            listEnds.push_back(std::min(chunkEnd, listEnds.back()));
+            i = chunk.dataStart + 4;
+        } else {
+            i = chunkEnd;
+        }
+        while (listEnds.size() > 1 && i + 8 > listEnds.back()) {
+            i = listEnds.back();
+            listEnds.pop_back();
+        }
+    }
+    return chunks;
+}
+
+/**
+ * A single step of an animated cursor
+ */
+struct AniAnimationStep {
+    /** The index of the displayed icon */
+    std::size_t iconIndex;
+    /** The display duration in jiffies (1/60th of a second) */
+    uint32_t jiffies;
+};
+
+/**
+ * If there is no 'seq ' chunk the icons are displayed in the stored order and if there is no 'rate'
+ * chunk every step is displayed for the default JifRate of the 'anih' chunk.
+ *
+ * @brief Get the animation steps of a `.ani` file
+ * @param aniFileInformation The read `.ani` file information
+ * @return The list of animation steps
+ */
+std::vector<AniAnimationStep> getAniAnimationSteps(const AniFileInformation &aniFileInformation)
+{
+    std::size_t stepCount = aniFileInformation.icons.size();
+    if (!aniFileInformation.sequence.empty()) {
+        stepCount = aniFileInformation.sequence.size();
+    } else if (!aniFileInformation.rate.empty()) {
+        stepCount = aniFileInformation.rate.size();
+    }
+    std::vector<AniAnimationStep> steps(stepCount);
+    for (std::size_t i = 0; i < stepCount; i++) {
+        steps.at(i).iconIndex = aniFileInformation.sequence.empty() ? i : aniFileInformation.sequence.at(i);
+        steps.at(i).jiffies = i < aniFileInformation.rate.size() ? aniFileInformation.rate.at(i) :
+                              aniFileInformation.JifRate;
+        if (steps.at(i).iconIndex >= aniFileInformation.icons.size()) {
+            throw std::runtime_error("Animation step #" + std::to_string(i) + " references the missing icon #" +
+                                     std::to_string(steps.at(i).iconIndex));
+        }
+    }
+    return steps;
+}
+
 /**
  * Source: https://stackoverflow.com/a/13001420
  *
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#include "aniFileExtractor.hpp"
+
+/** 'anih' flag: The frames are stored as icon/cursor data (and not as raw bitmaps) */
+constexpr uint32_t AF_ICON = 0x1;
+/** 'anih' flag: The animation contains a 'seq ' chunk */
+constexpr uint32_t AF_SEQUENCE = 0x2;
+
+/**
+ * @brief Get the size of a RIFF chunk (chunk id, chunk size and data padded to a WORD boundary)
+ */
+constexpr std::size_t riffChunkSize(const std::size_t dataLength)
+{
+    return 8 + dataLength + (dataLength % 2);
+}
+
+/**
+ * Sequential writer into a preallocated buffer (the buffer is never resized)
+ */
+class RiffWriter
+{
+public:
+    explicit RiffWriter(std::vector<uint8_t> &data) : data(data) {}
+
+    void writeFourCC(const std::string &fourCC)
+    {
+        for (std::size_t i = 0; i < 4; i++) {
+            data.at(position++) = static_cast<uint8_t>(fourCC.at(i));
+        }
+    }
+    void write32BitUnsignedInteger(const std::size_t number)
+    {
+        if (number > UINT32_MAX) {
+            throw std::runtime_error("RIFF value " + std::to_string(number) + " does not fit into a DWORD");
+        }
+        write32BitUnsignedIntegerLE(data, position, static_cast<uint32_t>(number));
+        position += 4;
+    }
+    void writeChunkHeader(const std::string &chunkId, const std::size_t dataLength)
+    {
+        writeFourCC(chunkId);
+        write32BitUnsignedInteger(dataLength);
+    }
+    template<typename T>
+    void writeChunk(const std::string &chunkId, const T &chunkData)
+    {
+        writeChunkHeader(chunkId, chunkData.size());
+        for (const auto &byte : chunkData) {
+            data.at(position++) = static_cast<uint8_t>(byte);
+        }
+        // The chunk data is always padded to the nearest WORD boundary
+        if (chunkData.size() % 2 == 1) {
+            data.at(position++) = 0;
+        }
+    }
+    void write32BitUnsignedIntegerChunk(const std::string &chunkId, const std::vector<uint32_t> &numbers)
+    {
+        writeChunkHeader(chunkId, numbers.size() * 4);
+        for (const auto number : numbers) {
+            write32BitUnsignedInteger(number);
+        }
+    }
+    std::size_t getPosition() const
+    {
+        return position;
+    }
+
+private:
+    std::vector<uint8_t> &data;
+    std::size_t position = 0;
+};
+
+/**
+ * Writes the following structure (see readAniFileInformation):
+ * "RIFF" {fileSize} "ACON"
+ *   "LIST" {length} "INFO" ["INAM" {length} {name}] ["IART" {length} {art}] (if name or art exist)
+ *   "anih" {36} {cbSizeOf, cFrames, cSteps, cx, cy, cBitCount, cPlanes, JifRate, flags}
+ *   "rate" {length} {cSteps DWORDs} (if the rate list is not empty)
+ *   "seq " {length} {cSteps DWORDs} (if the sequence list is not empty)
+ *   "LIST" {length} "fram" "icon" {length} {icon data} ...
+ *
+ * All chunk sizes are computed before writing so the file is created with a single allocation and
+ * strictly sequential writes (no length needs to be patched afterwards).
+ * The 'anih' values cbSizeOf, cFrames, cSteps and flags are derived from the other information so a
+ * read `.ani` file that uses the same chunk order is written again byte for byte.
+ *
+ * @brief Create the binary data of a `.ani` file
+ * @param aniFileInformation The information (icons must contain `.ico`/`.cur` file data)
+ * @return The `.ani` file binary data vector
+ */
+std::vector<uint8_t> createAniFile(const AniFileInformation &aniFileInformation)
+{
+    if (aniFileInformation.icons.empty()) {
+        throw std::runtime_error("An .ani file needs at least one icon");
+    }
+    const auto steps = getAniAnimationSteps(aniFileInformation);
+    if (!aniFileInformation.rate.empty() && aniFileInformation.rate.size() != steps.size()) {
+        throw std::runtime_error("The rate list must contain a value for every animation step");
+    }
+
+    std::size_t infoListLength = 0;
+    if (aniFileInformation.name.has_value()) {
+        infoListLength += riffChunkSize(aniFileInformation.name->size());
+    }
+    if (aniFileInformation.art.has_value()) {
+        infoListLength += riffChunkSize(aniFileInformation.art->size());
+    }
+    std::size_t framListLength = 4;
+    for (const auto &icon : aniFileInformation.icons) {
+        framListLength += riffChunkSize(icon.size());
+    }
+    std::size_t fileSize = 12 + riffChunkSize(36) + riffChunkSize(framListLength);
+    if (infoListLength > 0) {
+        fileSize += riffChunkSize(4 + infoListLength);
+    }
+    if (!aniFileInformation.rate.empty()) {
+        fileSize += riffChunkSize(aniFileInformation.rate.size() * 4);
+    }
+    if (!aniFileInformation.sequence.empty()) {
+        fileSize += riffChunkSize(aniFileInformation.sequence.size() * 4);
+    }
+
+    std::vector<uint8_t> data(fileSize);
+    RiffWriter writer(data);
+    writer.writeChunkHeader("RIFF", fileSize - 8);
+    writer.writeFourCC("ACON");
+    if (infoListLength > 0) {
+        writer.writeChunkHeader("LIST", 4 + infoListLength);
+        writer.writeFourCC("INFO");
+        if (aniFileInformation.name.has_value()) {
+            writer.writeChunk("INAM", aniFileInformation.name.value());
+        }
+        if (aniFileInformation.art.has_value()) {
+            writer.writeChunk("IART", aniFileInformation.art.value());
+        }
+    }
+    writer.writeChunkHeader("anih", 36);
+    writer.write32BitUnsignedInteger(36);
+    writer.write32BitUnsignedInteger(aniFileInformation.icons.size());
+    writer.write32BitUnsignedInteger(steps.size());
+    // cx, cy, cBitCount and cPlanes are reserved but some files still set them
+    writer.write32BitUnsignedInteger(aniFileInformation.cx);
+    writer.write32BitUnsignedInteger(aniFileInformation.cy);
+    writer.write32BitUnsignedInteger(aniFileInformation.cBitCount);
+    writer.write32BitUnsignedInteger(aniFileInformation.cPlanes);
+    writer.write32BitUnsignedInteger(aniFileInformation.JifRate);
+    writer.write32BitUnsignedInteger(AF_ICON | (aniFileInformation.sequence.empty() ? 0 : AF_SEQUENCE));
+    if (!aniFileInformation.rate.empty()) {
+        writer.write32BitUnsignedIntegerChunk("rate", aniFileInformation.rate);
+    }
+    if (!aniFileInformation.sequence.empty()) {
+        writer.write32BitUnsignedIntegerChunk("seq ", aniFileInformation.sequence);
+    }
+    writer.writeChunkHeader("LIST", framListLength);
+    writer.writeFourCC("fram");
+    for (const auto &icon : aniFileInformation.icons) {
+        writer.writeChunk("icon", icon);
+    }
+    if (writer.getPosition() != fileSize) {
+        throw std::runtime_error("The precomputed .ani file size does not match the written data");
+    }
+    return data;
+}
+
+/**
+ * Icon files can contain PNG image data so a PNG file is wrapped in an icon file with a single
+ * directory entry. The size is read from the IHDR chunk which must directly follow the signature.
+ *
+ * @brief Create the binary data of an `.ico` file that contains a single `.png` file
+ * @param pngData The `.png` file binary data vector
+ * @return The `.ico` file binary data vector
+ */
+std::vector<uint8_t> createIcoFileFromPng(const std::vector<uint8_t> &pngData)
+{
+    if (pngData.size() < 24 || pngData.at(0) != 137 || readCharString(pngData, 12, 4) != "IHDR") {
+        throw std::runtime_error("PNG data does not start with the png signature and an IHDR chunk");
+    }
+    auto width = static_cast<unsigned int>(read32BitUnsignedIntegerLE(pngData, 16));
+    auto height = static_cast<unsigned int>(read32BitUnsignedIntegerLE(pngData, 20));
+    endianSwap(width);
+    endianSwap(height);
+    if (width == 0 || height == 0 || width > 256 || height > 256) {
+        throw std::runtime_error("PNG images in icons must be between 1x1 and 256x256 pixels");
+    }
+    std::vector<uint8_t> data(6 + 16 + pngData.size());
+    write32BitUnsignedIntegerLE(data, 0, 0x00010000);
+    write32BitUnsignedIntegerLE(data, 4, 1);
+    // A width/height of 256 is stored as 0
+    data.at(6) = static_cast<uint8_t>(width);
+    data.at(7) = static_cast<uint8_t>(height);
+    write32BitUnsignedIntegerLE(data, 10, 0x00200001);
+    write32BitUnsignedIntegerLE(data, 14, static_cast<uint32_t>(pngData.size()));
+    write32BitUnsignedIntegerLE(data, 18, 22);
+    std::copy(pngData.begin(), pngData.end(), data.begin() + 22);
+    return data;
+}
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <iostream>
+#include <stdexcept>
+
+#include "aniFileExtractor.hpp"
+#include "icoImageDecoder.hpp"
+#include "paletteQuantizer.hpp"
+#include "pngWriter.hpp"
+#include "simd.hpp"
+
+/**
+ * @brief Count the equal pixels (4 bytes each) at the start of two rows (reference implementation)
+ */
+std::size_t countEqualLeadingPixelsReference(const uint8_t *a, const uint8_t *b,
+        const std::size_t pixelCount)
+{
+    std::size_t i = 0;
+    while (i < pixelCount && std::memcmp(a + i * 4, b + i * 4, 4) == 0) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Count the equal pixels (4 bytes each) at the end of two rows (reference implementation)
+ */
+std::size_t countEqualTrailingPixelsReference(const uint8_t *a, const uint8_t *b,
+        const std::size_t pixelCount)
+{
+    std::size_t i = 0;
+    while (i < pixelCount && std::memcmp(a + (pixelCount - 1 - i) * 4, b + (pixelCount - 1 - i) * 4,
+                                         4) == 0) {
+        i++;
+    }
+    return i;
+}
+
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+/**
+ * @brief AVX2 version of countEqualLeadingPixelsReference (compares 8 pixels per iteration)
+ */
+ANI_FILE_EXTRACTOR_TARGET("avx2")
+std::size_t countEqualLeadingPixelsAvx2(const uint8_t *a, const uint8_t *b,
+                                        const std::size_t pixelCount)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        const __m256i pixelsA = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i * 4));
+        const __m256i pixelsB = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i * 4));
+        const auto equalBytes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(pixelsA,
+                                pixelsB)));
+        if (equalBytes != 0xFFFFFFFF) {
+            return i + static_cast<std::size_t>(__builtin_ctz(~equalBytes)) / 4;
+        }
+    }
+    return i + countEqualLeadingPixelsReference(a + i * 4, b + i * 4, pixelCount - i);
+}
+
+/**
+ * @brief AVX2 version of countEqualTrailingPixelsReference (compares 8 pixels per iteration)
+ */
+ANI_FILE_EXTRACTOR_TARGET("avx2")
+std::size_t countEqualTrailingPixelsAvx2(const uint8_t *a, const uint8_t *b,
+        const std::size_t pixelCount)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        const std::size_t start = (pixelCount - i - 8) * 4;
+        const __m256i pixelsA = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + start));
+        const __m256i pixelsB = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + start));
+        const auto equalBytes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(pixelsA,
+                                pixelsB)));
+        if (equalBytes != 0xFFFFFFFF) {
+            return i + static_cast<std::size_t>(__builtin_clz(~equalBytes)) / 4;
+        }
+    }
+    return i + countEqualTrailingPixelsReference(a, b, pixelCount - i);
+}
+
+/**
+ * @brief SSE2 version of countEqualLeadingPixelsReference (compares 4 pixels per iteration)
+ */
+ANI_FILE_EXTRACTOR_TARGET("sse2")
+std::size_t countEqualLeadingPixelsSse2(const uint8_t *a, const uint8_t *b,
+                                        const std::size_t pixelCount)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4) {
+        const __m128i pixelsA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i * 4));
+        const __m128i pixelsB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i * 4));
+        const auto equalBytes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(pixelsA, pixelsB)));
+        if (equalBytes != 0xFFFF) {
+            return i + static_cast<std::size_t>(__builtin_ctz(~equalBytes)) / 4;
+        }
+    }
+    return i + countEqualLeadingPixelsReference(a + i * 4, b + i * 4, pixelCount - i);
+}
+
+/**
+ * @brief SSE2 version of countEqualTrailingPixelsReference (compares 4 pixels per iteration)
+ */
+ANI_FILE_EXTRACTOR_TARGET("sse2")
+std::size_t countEqualTrailingPixelsSse2(const uint8_t *a, const uint8_t *b,
+        const std::size_t pixelCount)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4) {
+        const std::size_t start = (pixelCount - i - 4) * 4;
+        const __m128i pixelsA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + start));
+        const __m128i pixelsB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + start));
+        const auto equalBytes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(pixelsA, pixelsB)));
+        if (equalBytes != 0xFFFF) {
+            // Only the lower 16 bits of the mask are used
+            return i + static_cast<std::size_t>(__builtin_clz(~equalBytes & 0xFFFF) - 16) / 4;
+        }
+    }
+    return i + countEqualTrailingPixelsReference(a, b, pixelCount - i);
+}
+#endif
+
+/**
+ * @brief Count the equal pixels (4 bytes each) at the start of two rows
+ */
+std::size_t countEqualLeadingPixels(const uint8_t *a, const uint8_t *b, const std::size_t pixelCount)
+{
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    if (cpuSupportsAvx2()) {
+        return countEqualLeadingPixelsAvx2(a, b, pixelCount);
+    }
+    return countEqualLeadingPixelsSse2(a, b, pixelCount);
+#else
+    return countEqualLeadingPixelsReference(a, b, pixelCount);
+#endif
+}
+
+/**
+ * @brief Count the equal pixels (4 bytes each) at the end of two rows
+ */
+std::size_t countEqualTrailingPixels(const uint8_t *a, const uint8_t *b, const std::size_t pixelCount)
+{
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    if (cpuSupportsAvx2()) {
+        return countEqualTrailingPixelsAvx2(a, b, pixelCount);
+    }
+    return countEqualTrailingPixelsSse2(a, b, pixelCount);
+#else
+    return countEqualTrailingPixelsReference(a, b, pixelCount);
+#endif
+}
+
+/**
+ * A rectangle of an image in pixels
+ */
+struct ImageRectangle {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/**
+ * @brief Find the smallest rectangle that contains all pixels that differ between two images
+ * @param previous The pixels of the previous image (4 bytes per pixel)
+ * @param current The pixels of the current image (4 bytes per pixel, same size as the previous one)
+ * @param width The image width in pixels
+ * @param height The image height in pixels
+ * @return The rectangle or nothing if the images are identical
+ */
+std::optional<ImageRectangle> findChangedRectangle(const std::vector<uint8_t> &previous,
+        const std::vector<uint8_t> &current, const uint32_t width, const uint32_t height)
+{
+    uint32_t left = width;
+    uint32_t right = 0;
+    uint32_t top = height;
+    uint32_t bottom = 0;
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t *rowPrevious = previous.data() + static_cast<std::size_t>(y) * width * 4;
+        const uint8_t *rowCurrent = current.data() + static_cast<std::size_t>(y) * width * 4;
+        const auto leading = static_cast<uint32_t>(countEqualLeadingPixels(rowPrevious, rowCurrent, width));
+        if (leading == width) {
+            continue;
+        }
+        const auto trailing = static_cast<uint32_t>(countEqualTrailingPixels(rowPrevious, rowCurrent,
+                              width));
+        top = std::min(top, y);
+        bottom = y + 1;
+        left = std::min(left, leading);
+        right = std::max(right, width - trailing);
+    }
+    if (top == height) {
+        return std::nullopt;
+    }
+    return ImageRectangle { left, top, right - left, bottom - top };
+}
+
+/** The maximum number of compared and encoded pixels per pixel of the images (see createApngFile) */
+constexpr uint64_t apngMaxPixelsPerImagePixel = 64;
+
+/**
+ * A frame of an animated PNG
+ */
+struct ApngFrame {
+    /** The index of the canvas that contains the pixels */
+    std::size_t canvasIndex;
+    /** The area of the canvas that is updated by this frame */
+    ImageRectangle rectangle;
+    /** The display duration in jiffies (1/60th of a second) */
+    uint32_t jiffies;
+};
+
+/**
+ * Sources:
+ * - https://wiki.mozilla.org/APNG_Specification
+ *
+ * An APNG file is a PNG file with the additional chunks:
+ * - "acTL" {4 Bytes=num_frames} {4 Bytes=num_plays (0=infinite)} (before the first IDAT chunk)
+ * - "fcTL" {4 Bytes=sequence_number} {4 Bytes=width} {4 Bytes=height} {4 Bytes=x_offset}
+ *          {4 Bytes=y_offset} {2 Bytes=delay_num} {2 Bytes=delay_den} {1 Byte=dispose_op}
+ *          {1 Byte=blend_op} (before the image data of every frame)
+ * - "fdAT" {4 Bytes=sequence_number} {image data} (image data of every frame after the first one)
+ * All numbers are stored in big-endian byte order.
+ *
+ * The first frame is stored as IDAT (so programs without APNG support show it) and every following
+ * frame only contains the rectangle that changed since the previous frame (dispose_op=NONE,
+ * blend_op=SOURCE). Consecutive identical frames are merged into one frame with a longer delay.
+ * If quantization is enabled all frames share one palette (color type 3 with "PLTE" and "tRNS").
+ *
+ * All images must have the same size (they are used as canvas without a copy). Steps that show the
+ * image of the previous step are merged without comparing the pixels and the changed rectangle of
+ * every image pair is only searched once. The compared and encoded pixels are limited to
+ * apngMaxPixelsPerImagePixel times the pixels of all images, so a long 'seq ' chunk that alternates
+ * between different images is rejected instead of multiplying the work and the output.
+ *
+ * @brief Create the binary data of an animated PNG file
+ * @param images The decoded images of the animation
+ * @param steps The animation steps that reference the images
+ * @param quantize Store palette indices instead of RGBA pixels (see quantizeImages)
+ * @return The APNG file binary data vector
+ */
+std::vector<uint8_t> createApngFile(const std::vector<RgbaImage> &images,
+                                    const std::vector<AniAnimationStep> &steps, const bool quantize = false)
+{
+    if (steps.empty()) {
+        throw std::runtime_error("An animated PNG needs at least one frame");
+    }
+    const uint32_t canvasWidth = images.at(0).width;
+    const uint32_t canvasHeight = images.at(0).height;
+    for (std::size_t i = 1; i < images.size(); i++) {
+        if (images.at(i).width != canvasWidth || images.at(i).height != canvasHeight) {
+            throw std::runtime_error("Image " + std::to_string(i) + " (" + std::to_string(images.at(i).width) + "x" +
+                                     std::to_string(images.at(i).height) + ") does not have the size of the first image (" +
+                                     std::to_string(canvasWidth) + "x" + std::to_string(canvasHeight) + ")");
+        }
+    }
+    const auto &canvases = images;
+    const auto quantizedCanvases = quantize ? quantizeImages(canvases) : QuantizedImages {};
+
+    const uint64_t canvasPixels = static_cast<uint64_t>(canvasWidth) * canvasHeight;
+    const uint64_t maxPixels = apngMaxPixelsPerImagePixel * canvasPixels * images.size();
+    uint64_t pixels = canvasPixels;
+    const auto addPixels = [&](const uint64_t count) {
+        pixels += count;
+        if (pixels > maxPixels) {
+            throw std::runtime_error("The animation needs more than " + std::to_string(apngMaxPixelsPerImagePixel) +
+                                     " times the pixels of its images");
+        }
+    };
+    std::map<std::pair<std::size_t, std::size_t>, std::optional<ImageRectangle>> changedRectangles {};
+    std::vector<ApngFrame> frames {};
+    for (const auto &step : steps) {
+        if (frames.empty()) {
+            frames.push_back({ step.iconIndex, { 0, 0, canvasWidth, canvasHeight }, step.jiffies });
+            continue;
+        }
+        auto &lastFrame = frames.back();
+        std::optional<ImageRectangle> changedRectangle {};
+        if (step.iconIndex != lastFrame.canvasIndex) {
+            const auto [changedRectanglesEntry, searched] = changedRectangles.try_emplace(std::pair{
+                lastFrame.canvasIndex, step.iconIndex });
+            if (searched) {
+                addPixels(canvasPixels);
+                changedRectanglesEntry->second = findChangedRectangle(canvases.at(lastFrame.canvasIndex).pixels,
+                                                 canvases.at(step.iconIndex).pixels, canvasWidth, canvasHeight);
+            }
+            changedRectangle = changedRectanglesEntry->second;
+        }
+        // The delay numerator is stored as 16 bit number
+        if (!changedRectangle.has_value() && lastFrame.jiffies + step.jiffies <= UINT16_MAX) {
+            lastFrame.jiffies += step.jiffies;
+            continue;
+        }
+        frames.push_back({ step.iconIndex, changedRectangle.value_or(ImageRectangle { 0, 0, 1, 1 }), step.jiffies });
+        addPixels(static_cast<uint64_t>(frames.back().rectangle.width) * frames.back().rectangle.height);
+    }
+    if constexpr(debug) {
+        std::cout << "> Animated PNG contains " << frames.size() << " frames (" << steps.size() << " steps)" <<
+                  std::endl;
+    }
+
+    std::vector<uint8_t> png {};
+    appendPngSignature(png);
+    std::vector<uint8_t> chunk {};
+    append32BitUnsignedIntegerBE(chunk, canvasWidth);
+    append32BitUnsignedIntegerBE(chunk, canvasHeight);
+    // Bit depth 8, color type 6 (RGBA) or 3 (palette), compression 0, filter 0, no interlacing
+    chunk.insert(chunk.end(), { 8, static_cast<uint8_t>(quantize ? 3 : 6), 0, 0, 0 });
+    appendPngChunk(png, "IHDR", chunk);
+    if (quantize) {
+        chunk.clear();
+        std::vector<uint8_t> transparency {};
+        for (const auto &color : quantizedCanvases.palette) {
+            chunk.insert(chunk.end(), color.begin(), color.begin() + 3);
+            if (color.at(3) < 255) {
+                transparency.push_back(color.at(3));
+            }
+        }
+        appendPngChunk(png, "PLTE", chunk);
+        if (!transparency.empty()) {
+            appendPngChunk(png, "tRNS", transparency);
+        }
+    }
+    chunk.clear();
+    append32BitUnsignedIntegerBE(chunk, static_cast<uint32_t>(frames.size()));
+    append32BitUnsignedIntegerBE(chunk, 0);
+    appendPngChunk(png, "acTL", chunk);
+
+    uint32_t sequenceNumber = 0;
+    for (std::size_t i = 0; i < frames.size(); i++) {
+        const auto &frame = frames.at(i);
+        chunk.clear();
+        append32BitUnsignedIntegerBE(chunk, sequenceNumber++);
+        append32BitUnsignedIntegerBE(chunk, frame.rectangle.width);
+        append32BitUnsignedIntegerBE(chunk, frame.rectangle.height);
+        append32BitUnsignedIntegerBE(chunk, frame.rectangle.x);
+        append32BitUnsignedIntegerBE(chunk, frame.rectangle.y);
+        const auto delay = static_cast<uint16_t>(std::min<uint32_t>(frame.jiffies, UINT16_MAX));
+        chunk.insert(chunk.end(), { static_cast<uint8_t>(delay >> 8), static_cast<uint8_t>(delay), 0, 60, 0, 0 });
+        appendPngChunk(png, "fcTL", chunk);
+
+        const std::size_t bytesPerPixel = quantize ? 1 : 4;
+        const std::size_t stride = static_cast<std::size_t>(canvasWidth) * bytesPerPixel;
+        const uint8_t *pixels = quantize ? quantizedCanvases.indices.at(frame.canvasIndex).data() :
+                                canvases.at(frame.canvasIndex).pixels.data();
+        const auto imageData = encodePngImageData(pixels + frame.rectangle.y * stride +
+                               frame.rectangle.x * bytesPerPixel, stride, frame.rectangle.width,
+                               frame.rectangle.height, bytesPerPixel);
+        if (i == 0) {
+            appendPngChunk(png, "IDAT", imageData);
+        } else {
+            chunk.clear();
+            append32BitUnsignedIntegerBE(chunk, sequenceNumber++);
+            chunk.insert(chunk.end(), imageData.begin(), imageData.end());
+            appendPngChunk(png, "fdAT", chunk);
+        }
+    }
+    appendPngChunk(png, "IEND", {});
+    return png;
+}
+
+/**
+ * @brief Convert the icons of a `.ani` file to an animated PNG file
+ * @param aniFileInformation The read `.ani` file information
+ * @param quantize Use a shared palette for all frames
+ * @return The APNG file binary data vector
+ */
+std::vector<uint8_t> convertAniToApng(const AniFileInformation &aniFileInformation,
+                                      const bool quantize = false)
+{
+    std::vector<RgbaImage> images {};
+    images.reserve(aniFileInformation.icons.size());
+    for (const auto &icon : aniFileInformation.icons) {
+        images.push_back(decodeIcoImage(icon));
+    }
+    return createApngFile(images, getAniAnimationSteps(aniFileInformation), quantize);
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aniFileExtractor.hpp"
+#include "printFileInformation.hpp"
+
+/**
+ * Thread-safe FIFO queue with a maximum size.
+ * Producers wait while the queue is full (back-pressure) and consumers wait while it is empty.
+ * After the queue was closed no items can be pushed and pop returns nothing once it is empty.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(const std::size_t capacity) : capacity(std::max<std::size_t>(capacity, 1)) {}
+
+    /**
+     * @return False if the queue was closed (the item was not added)
+     */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+    /**
+     * @return The next item or nothing if the queue was closed and is empty
+     */
+    std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return item;
+    }
+    void close()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+    /**
+     * Close the queue and discard all items that were not processed yet
+     */
+    void abort()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            items.clear();
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+private:
+    const std::size_t capacity;
+    std::deque<T> items = {};
+    bool closed = false;
+    std::mutex mutex = {};
+    std::condition_variable notFull = {};
+    std::condition_variable notEmpty = {};
+};
+
+/**
+ * Start worker threads that apply a function to every item of an input queue and push the results
+ * into an output queue (which is closed after the last worker finished).
+ * The items must have an `index`. Items for which `isSkipped` returns true are dropped. If the function
+ * throws the error handler is called with the index of the item and the worker continues with the
+ * next item (so the items before a failed item are still processed).
+ *
+ * @brief Start a pipeline stage
+ * @param threads The list to which the started worker threads are added
+ * @param threadCount The number of worker threads
+ * @param input The input queue
+ * @param output The output queue
+ * @param function The function that converts an input item to an output item
+ * @param isSkipped Returns if the item with the given index should be dropped
+ * @param onError The error handler
+ */
+template<typename In, typename Out, typename Function>
+void startPipelineStage(std::vector<std::jthread> &threads, const std::size_t threadCount,
+                        BoundedQueue<In> &input, BoundedQueue<Out> &output, Function function,
+                        const std::function<bool(std::size_t)> &isSkipped,
+                        const std::function<void(std::size_t, std::exception_ptr)> &onError)
+{
+    auto runningWorkers = std::make_shared<std::atomic<std::size_t>>(threadCount);
+    for (std::size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back([&input, &output, function, isSkipped, onError, runningWorkers] {
+            while (auto item = input.pop()) {
+                const std::size_t index = item->index;
+                if (isSkipped(index)) {
+                    continue;
+                }
+                try {
+                    if (!output.push(function(std::move(item.value())))) {
+                        break;
+                    }
+                } catch (...) {
+                    onError(index, std::current_exception());
+                }
+            }
+            if (runningWorkers->fetch_sub(1) == 1) {
+                output.close();
+            }
+        });
+    }
+}
+
+/**
+ * Calls a function when it is destroyed (used to abort the pipeline queues if the extraction is left
+ * by an exception, so the worker threads finish and can be joined)
+ */
+class PipelineScopeGuard
+{
+public:
+    explicit PipelineScopeGuard(std::function<void()> function) : function(std::move(function)) {}
+    PipelineScopeGuard(const PipelineScopeGuard &) = delete;
+    PipelineScopeGuard &operator=(const PipelineScopeGuard &) = delete;
+    ~PipelineScopeGuard()
+    {
+        function();
+    }
+
+private:
+    std::function<void()> function;
+};
+
+/**
+ * Icon data of a frame as found by the RIFF scanner (view into the `.ani` file data)
+ */
+struct PipelineFrameView {
+    std::size_t index;
+    std::span<const uint8_t> data;
+};
+
+/**
+ * Frame whose icon header was parsed
+ */
+struct PipelineDecodedFrame {
+    std::size_t index;
+    /** View into the `.ani` file data (the icon data is not copied) */
+    std::span<const uint8_t> data;
+    /** The console output of this frame */
+    std::string log;
+    /** The line of this frame in the X11 cursor config template */
+    std::string templateLine;
+};
+
+/**
+ * Frame that was written to a temporary file and only needs to be committed (renamed, console
+ * output, template)
+ */
+struct PipelineWrittenFrame {
+    std::size_t index;
+    std::string log;
+    std::string templateLine;
+};
+
+/**
+ * The extraction is split into stages that run at the same time:
+ * 1. RIFF scan (1 thread):      pushes a view of every found icon into the frame queue
+ * 2. Decode (threads / 2):      parses the icon header and formats the information table
+ * 3. Write (threads / 2):       writes the icon into a temporary `.ico.part` file
+ * 4. Commit (calling thread):   renames the files, prints the output and builds the template in
+ *                               frame order
+ *
+ * All queues are bounded so a slow stage stops the previous stages instead of buffering the whole
+ * file. The console output and the written files are the same as if all frames were extracted one
+ * after another on a single thread: if a frame fails the frames before it are still processed and
+ * committed, the frames after it are dropped (and their temporary files removed), and if the scan
+ * fails no frame is committed. The reported error is the scan error or else the one of the first
+ * failed frame.
+ *
+ * @brief Extract all icons of an `.ani` file and an X11 cursor config template into a directory
+ * @param filePath The `.ani` file path
+ * @param outDir The output directory (is created if it does not exist)
+ * @param threadCount The number of worker threads (split between the decode and the write stage)
+ */
+void extractAniFile(const std::filesystem::path &filePath, const std::filesystem::path &outDir,
+                    const std::size_t threadCount)
+{
+    if (!std::filesystem::exists(outDir)) {
+        std::filesystem::create_directory(outDir);
+    }
+    std::filesystem::path imageOutputFilePathPrefix = outDir / filePath;
+    if (filePath.has_extension()) {
+        imageOutputFilePathPrefix = outDir / filePath.stem();
+    }
+    const auto stem = filePath.stem().string();
+    const auto dataBytes = readBinaryFile(filePath);
+    const std::size_t decodeWorkerCount = std::max<std::size_t>((threadCount + 1) / 2, 1);
+    const std::size_t writeWorkerCount = std::max<std::size_t>(threadCount / 2, 1);
+    const auto frameFilePath = [&](const std::size_t index) {
+        return std::filesystem::path(imageOutputFilePathPrefix.string() + "_" + std::to_string(index) + ".ico");
+    };
+    const auto temporaryFrameFilePath = [&](const std::size_t index) {
+        return std::filesystem::path(frameFilePath(index).string() + ".part");
+    };
+
+    BoundedQueue<PipelineFrameView> frameQueue(2 * decodeWorkerCount);
+    BoundedQueue<PipelineDecodedFrame> decodedQueue(2 * writeWorkerCount);
+    BoundedQueue<PipelineWrittenFrame> writtenQueue(2 * writeWorkerCount);
+    // The error rank is 0 for a scan error and index + 1 for an error of a frame (the lowest wins)
+    std::mutex errorMutex {};
+    std::exception_ptr error {};
+    std::size_t errorRank = SIZE_MAX;
+    // Frames with this index or higher are not processed anymore
+    std::atomic<std::size_t> firstFailedFrame = SIZE_MAX;
+    const auto onError = [&](const std::size_t rank, std::exception_ptr exception) {
+        const std::lock_guard<std::mutex> lock(errorMutex);
+        if (rank < errorRank) {
+            errorRank = rank;
+            error = exception;
+            firstFailedFrame.store(rank == 0 ? 0 : rank - 1, std::memory_order_relaxed);
+        }
+    };
+    const std::function<bool(std::size_t)> isSkipped = [&](const std::size_t index) {
+        return index >= firstFailedFrame.load(std::memory_order_relaxed);
+    };
+    const std::function<void(std::size_t, std::exception_ptr)> onFrameError =
+    [&](const std::size_t index, std::exception_ptr exception) {
+        onError(index + 1, exception);
+    };
+
+    std::ostringstream scanLog {};
+    std::atomic<bool> scanFinished = false;
+    std::vector<std::jthread> threads {};
+    // Declared after the threads so the queues are aborted before the threads are joined
+    PipelineScopeGuard abortQueues([&] {
+        frameQueue.abort();
+        decodedQueue.abort();
+        writtenQueue.abort();
+    });
+    threads.emplace_back([&] {
+        // The whole file is always scanned because a scan error takes precedence over frame errors
+        try {
+            readAniFileInformation(dataBytes, [&](const std::size_t index, const std::span<const uint8_t> data) {
+                if (!isSkipped(index)) {
+                    frameQueue.push(PipelineFrameView { index, data });
+                }
+            }, scanLog);
+        } catch (...) {
+            onError(0, std::current_exception());
+        }
+        scanFinished.store(true, std::memory_order_release);
+        frameQueue.close();
+    });
+    startPipelineStage(threads, decodeWorkerCount, frameQueue, decodedQueue, [&](PipelineFrameView view) {
+        PipelineDecodedFrame frame { view.index, view.data, {}, {} };
+        std::ostringstream log {};
+        const auto icoInformation = printIcoInformation(frame.data, 0, log);
+        frame.log = log.str();
+        frame.templateLine = std::to_string(icoInformation.directoryHeaders.at(0).width) + " 2 4 " + stem + "_" +
+                             std::to_string(frame.index) + ".png TODO_MS\n";
+        return frame;
+    }, isSkipped, onFrameError);
+    startPipelineStage(threads, writeWorkerCount, decodedQueue, writtenQueue, [&](PipelineDecodedFrame frame) {
+        std::ostringstream log {};
+        log << frame.log;
+        {
+            StatisticsScopedTimer timer(StatisticsPhase::FRAME_WRITE, frame.data.size());
+            std::ostream discard(nullptr);
+            writeBinaryFile(temporaryFrameFilePath(frame.index), frame.data, discard);
+        }
+        logFileWritten(log, frameFilePath(frame.index), frame.data.size());
+        return PipelineWrittenFrame { frame.index, log.str(), std::move(frame.templateLine) };
+    }, isSkipped, onFrameError);
+
+    // Commit the frames in order (the scan output is printed first like in a sequential run)
+    std::map<std::size_t, PipelineWrittenFrame> pendingFrames {};
+    std::size_t nextIndex = 0;
+    bool scanLogPrinted = false;
+    std::string x11cursorConfigTemplate {};
+    const auto commitFrames = [&] {
+        if (!scanLogPrinted) {
+            if (!scanFinished.load(std::memory_order_acquire)) {
+                return;
+            }
+            std::cout << scanLog.str() << std::flush;
+            scanLogPrinted = true;
+        }
+        while (!pendingFrames.empty() && pendingFrames.begin()->first == nextIndex &&
+               !isSkipped(nextIndex)) {
+            std::filesystem::rename(temporaryFrameFilePath(nextIndex), frameFilePath(nextIndex));
+            std::cout << pendingFrames.begin()->second.log << std::flush;
+            x11cursorConfigTemplate.append(pendingFrames.begin()->second.templateLine);
+            pendingFrames.erase(pendingFrames.begin());
+            nextIndex++;
+        }
+    };
+    while (auto frame = writtenQueue.pop()) {
+        pendingFrames.emplace(frame->index, std::move(frame.value()));
+        commitFrames();
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    // Frames before an error are still committed, the written frames after it are removed
+    commitFrames();
+    for (const auto &pendingFrame : pendingFrames) {
+        std::filesystem::remove(temporaryFrameFilePath(pendingFrame.first));
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    StatisticsScopedTimer timer(StatisticsPhase::TEMPLATE_WRITE, x11cursorConfigTemplate.size());
+    writeTextFile(outDir / (stem + "_template.cursor"), x11cursorConfigTemplate);
+}
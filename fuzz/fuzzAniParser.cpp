@@ -0,0 +1,28 @@
+// Fuzz target for the `.ani` parsers (readAniFileInformation, getAniAnimationSteps, printAniInformation)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "aniFileExtractor.hpp"
+#include "printFileInformation.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+    const std::vector<uint8_t> input(data, data + size);
+    // A stream without buffer discards the output
+    std::ostream discard(nullptr);
+    try {
+        getAniAnimationSteps(readAniFileInformation(input, {}, discard));
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    try {
+        printAniInformation(input, discard);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+// Fuzz target for the animated PNG conversion of `.ani` files (convertAniToApng with and without quantizeImages)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "aniFileExtractor.hpp"
+#include "apngWriter.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+    const std::vector<uint8_t> input(data, data + size);
+    // A stream without buffer discards the output
+    std::ostream discard(nullptr);
+    try {
+        const auto aniFileInformation = readAniFileInformation(input, {}, discard);
+        convertAniToApng(aniFileInformation, false);
+        convertAniToApng(aniFileInformation, true);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+// Fuzz target for the `.ico`/`.cur` parser and decoder (printIcoInformation, decodeIcoImage, decodeIcoDib)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "icoImageDecoder.hpp"
+#include "printFileInformation.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+    const std::vector<uint8_t> input(data, data + size);
+    // A stream without buffer discards the output
+    std::ostream discard(nullptr);
+    try {
+        printIcoInformation(input, 0, discard);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    try {
+        decodeIcoImage(input);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    // The input is also decoded as a bare DIB so the mutations do not need a valid icon directory
+    try {
+        decodeIcoDib(input, 0, input.size());
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    return 0;
+}
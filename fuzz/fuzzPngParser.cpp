@@ -0,0 +1,22 @@
+// Fuzz target for the `.png` parser (printPngInformation)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "printFileInformation.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+    const std::vector<uint8_t> input(data, data + size);
+    // A stream without buffer discards the output
+    std::ostream discard(nullptr);
+    try {
+        printPngInformation(input, 0, discard);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+// Fuzz target for the RIFF chunk list and the hex dump selectors (listRiffChunks, printHexDumpSelection)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hexDump.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+    const std::vector<uint8_t> input(data, data + size);
+    // A stream without buffer discards the output
+    std::ostream discard(nullptr);
+    // Every kind of selector (FOURCC in and outside of lists, chunk index, byte range)
+    const std::vector<std::string> selectors {"anih", "icon", "#0", "#2", "0-64"};
+    try {
+        listRiffChunks(input);
+        printHexDumpSelection(input, selectors, discard);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+// Fuzz target for the X11 cursor conversion of `.ani` files (convertAniToX11Cursor)
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "aniFileExtractor.hpp"
+#include "x11CursorWriter.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+    const std::vector<uint8_t> input(data, data + size);
+    // A stream without buffer discards the output
+    std::ostream discard(nullptr);
+    try {
+        const auto aniFileInformation = readAniFileInformation(input, {}, discard);
+        convertAniToX11Cursor(aniFileInformation);
+    } catch (const std::exception &) {
+        // Malformed data is rejected with an exception
+    }
+    return 0;
+}
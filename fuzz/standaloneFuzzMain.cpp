@@ -0,0 +1,419 @@
+// Standalone driver for the fuzz targets (used if the compiler does not support libFuzzer)
+//
+// $ fuzzAniParser [--timing] [--max-exponent=X] [--max-cost-factor=X] INPUT_FILE_OR_DIRECTORY...
+//
+// Every input is run once through the fuzz target.
+// With --timing every well-formed input is additionally scaled up by repeating parts of it (the
+// result is still well-formed so the fuzz target does not stop early):
+// - `.ani` (RIFF) "frames": every 'icon' chunk is repeated
+// - `.ani` (RIFF) "steps":  the entries of the 'seq ' and 'rate' chunks are repeated
+// - `.ico`/`.cur` "images": the directory entries and the image data are repeated
+// - `.png` "chunks":         the chunks between 'IHDR' and 'IEND' are repeated
+// The scaled inputs are 4-32 times bigger than the input. An input is flagged if the time of the added
+// parts grows faster than linear with their size (the exponent of the fitted `time ~ size^exponent`
+// curve is bigger than --max-exponent) or if every added byte costs more than --max-cost-factor times
+// the time per byte of the input (a small part of the input that multiplies the work or the output).
+// The exit code is 1 if an input was flagged.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size);
+
+/** The minimum time over which the runs of a single measurement are averaged */
+constexpr std::chrono::milliseconds fuzzTimingMinimumDuration {5};
+/** The number of measurements of which the fastest is used (slower ones were disturbed) */
+constexpr std::size_t fuzzTimingRepetitions = 5;
+/** Measurements that take longer than this are not repeated */
+constexpr std::chrono::milliseconds fuzzTimingMaximumRepeatedDuration {500};
+/** The bytes that are added to an input by the smallest scale factor (relative to the input size) */
+constexpr std::size_t fuzzScalingMinimumGrowth = 4;
+/** The maximum size of a scaled input */
+constexpr std::size_t fuzzScalingMaximumSize = 16 << 20;
+
+/**
+ * @brief Read binary data from file to vector
+ */
+std::vector<uint8_t> readFuzzInput(const std::filesystem::path &filePath)
+{
+    std::ifstream inputFile(filePath, std::ios::in | std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(inputFile), {});
+}
+
+/**
+ * @brief Collect all files of the given files and directories (directories are searched recursively)
+ */
+std::vector<std::filesystem::path> collectFuzzInputs(const std::vector<std::string> &paths)
+{
+    std::vector<std::filesystem::path> inputs {};
+    for (const auto &path : paths) {
+        if (std::filesystem::is_directory(path)) {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file()) {
+                    inputs.push_back(entry.path());
+                }
+            }
+        } else {
+            inputs.emplace_back(path);
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+    return inputs;
+}
+
+uint32_t readFuzzUint32LE(const std::vector<uint8_t> &data, const std::size_t start)
+{
+    return static_cast<uint32_t>(data.at(start)) | static_cast<uint32_t>(data.at(start + 1)) << 8 |
+           static_cast<uint32_t>(data.at(start + 2)) << 16 | static_cast<uint32_t>(data.at(start + 3)) << 24;
+}
+
+uint16_t readFuzzUint16LE(const std::vector<uint8_t> &data, const std::size_t start)
+{
+    return static_cast<uint16_t>(data.at(start) | data.at(start + 1) << 8);
+}
+
+uint32_t readFuzzUint32BE(const std::vector<uint8_t> &data, const std::size_t start)
+{
+    return static_cast<uint32_t>(data.at(start)) << 24 | static_cast<uint32_t>(data.at(start + 1)) << 16 |
+           static_cast<uint32_t>(data.at(start + 2)) << 8 | static_cast<uint32_t>(data.at(start + 3));
+}
+
+void writeFuzzUint32LE(std::vector<uint8_t> &data, const std::size_t start, const uint32_t number)
+{
+    for (std::size_t i = 0; i < 4; i++) {
+        data.at(start + i) = static_cast<uint8_t>(number >> (i * 8));
+    }
+}
+
+/**
+ * Copies the RIFF chunks of a range and updates the sizes of the enclosing 'RIFF'/'LIST' chunks:
+ * - "frames": the 'icon' chunks are repeated, the 'seq ' entries are repeated for the copied icons
+ *   and the 'rate' entries are repeated
+ * - "steps":  the entries of the 'seq ' and 'rate' chunks are repeated
+ * The frame and step counts of the 'anih' chunk are multiplied with the factor.
+ * Data that is not a complete chunk is copied unchanged.
+ *
+ * @brief Append the scaled chunks of a RIFF file range
+ * @param data The input data
+ * @param start The start of the range
+ * @param end The end of the range (exclusive)
+ * @param scaling "frames" or "steps"
+ * @param factor How often the repeated chunks or chunk data are written
+ * @param out The scaled data
+ */
+void appendScaledRiffChunks(const std::vector<uint8_t> &data, const std::size_t start, const std::size_t end,
+                            const std::string &scaling, const std::size_t factor, std::vector<uint8_t> &out)
+{
+    std::size_t i = start;
+    while (i + 8 <= end) {
+        const std::string id(data.begin() + static_cast<std::ptrdiff_t>(i),
+                             data.begin() + static_cast<std::ptrdiff_t>(i + 4));
+        const std::size_t length = readFuzzUint32LE(data, i + 4);
+        if (length > end - i - 8) {
+            break;
+        }
+        const auto chunkData = data.begin() + static_cast<std::ptrdiff_t>(i + 8);
+        if ((id == "RIFF" || id == "LIST") && length >= 4) {
+            out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(i), chunkData + 4);
+            const std::size_t sizePosition = out.size() - 8;
+            appendScaledRiffChunks(data, i + 12, i + 8 + length, scaling, factor, out);
+            writeFuzzUint32LE(out, sizePosition, static_cast<uint32_t>(out.size() - sizePosition - 4));
+        } else {
+            const std::size_t copies = scaling == "frames" && id == "icon" ? factor : 1;
+            const std::size_t dataCopies = (id == "seq " || id == "rate") && length % 4 == 0 ? factor : 1;
+            for (std::size_t copy = 0; copy < copies; copy++) {
+                out.insert(out.end(), id.begin(), id.end());
+                out.resize(out.size() + 4);
+                writeFuzzUint32LE(out, out.size() - 4, static_cast<uint32_t>(length * dataCopies));
+                for (std::size_t dataCopy = 0; dataCopy < dataCopies; dataCopy++) {
+                    const std::size_t dataStart = out.size();
+                    out.insert(out.end(), chunkData, chunkData + static_cast<std::ptrdiff_t>(length));
+                    // The copied steps show the copied icons (every icon is followed by its copies)
+                    for (std::size_t entry = dataStart; scaling == "frames" && id == "seq " && entry < out.size();
+                         entry += 4) {
+                        writeFuzzUint32LE(out, entry, static_cast<uint32_t>(readFuzzUint32LE(out,
+                                          entry) * factor + dataCopy));
+                    }
+                }
+                if (id == "anih" && length >= 12) {
+                    const std::size_t anihStart = out.size() - length;
+                    if (scaling == "frames") {
+                        writeFuzzUint32LE(out, anihStart + 4, static_cast<uint32_t>(readFuzzUint32LE(out,
+                                          anihStart + 4) * factor));
+                    }
+                    writeFuzzUint32LE(out, anihStart + 8, static_cast<uint32_t>(readFuzzUint32LE(out,
+                                      anihStart + 8) * factor));
+                }
+                if ((length * dataCopies) % 2 == 1) {
+                    out.push_back(0);
+                }
+            }
+        }
+        i += 8 + length + (length % 2);
+    }
+    out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(std::min(i, end)),
+               data.begin() + static_cast<std::ptrdiff_t>(end));
+}
+
+/**
+ * @brief Scale a well-formed input by repeating parts of it (see the description at the top)
+ * @param data The input data
+ * @param scaling The name of the scaling
+ * @param factor How often the repeated parts are contained in the result (1 = unchanged)
+ * @return The scaled input
+ */
+std::vector<uint8_t> scaleFuzzInput(const std::vector<uint8_t> &data, const std::string &scaling,
+                                    const std::size_t factor)
+{
+    std::vector<uint8_t> out {};
+    if (scaling == "frames" || scaling == "steps") {
+        appendScaledRiffChunks(data, 0, data.size(), scaling, factor, out);
+    } else if (scaling == "images") {
+        const std::size_t entryCount = readFuzzUint16LE(data, 4);
+        const std::size_t directoryEnd = 6 + entryCount * 16;
+        const std::size_t imageDataSize = data.size() - directoryEnd;
+        out.insert(out.end(), data.begin(), data.begin() + 6);
+        out.at(4) = static_cast<uint8_t>(entryCount * factor);
+        out.at(5) = static_cast<uint8_t>((entryCount * factor) >> 8);
+        // Every copy of the directory points to its own copy of the image data
+        for (std::size_t copy = 0; copy < factor; copy++) {
+            const auto shift = static_cast<uint32_t>(entryCount * 16 * (factor - 1) + imageDataSize * copy);
+            for (std::size_t entry = 6; entry < directoryEnd; entry += 16) {
+                out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(entry),
+                           data.begin() + static_cast<std::ptrdiff_t>(entry + 16));
+                writeFuzzUint32LE(out, out.size() - 4, readFuzzUint32LE(data, entry + 12) + shift);
+            }
+        }
+        for (std::size_t copy = 0; copy < factor; copy++) {
+            out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(directoryEnd), data.end());
+        }
+    } else if (scaling == "chunks") {
+        // The chunks after the first one ('IHDR') up to the last one ('IEND')
+        const std::size_t middleStart = 8 + 12 + readFuzzUint32BE(data, 8);
+        const std::size_t middleEnd = data.size() - 12;
+        out.insert(out.end(), data.begin(), data.begin() + static_cast<std::ptrdiff_t>(middleStart));
+        for (std::size_t copy = 0; copy < factor; copy++) {
+            out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(middleStart),
+                       data.begin() + static_cast<std::ptrdiff_t>(middleEnd));
+        }
+        out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(middleEnd), data.end());
+    }
+    return out;
+}
+
+/**
+ * @brief Get the scalings that can be applied to an input (nothing if the format is not recognized)
+ */
+std::vector<std::string> getFuzzInputScalings(const std::vector<uint8_t> &data)
+{
+    if (data.size() >= 12 && std::equal(data.begin(), data.begin() + 4, "RIFF")) {
+        return { "frames", "steps" };
+    }
+    constexpr uint8_t pngSignature[] = {137, 'P', 'N', 'G', 13, 10, 26, 10};
+    if (data.size() >= 8 + 2 * 12 && std::equal(data.begin(), data.begin() + 8, pngSignature) &&
+        std::equal(data.end() - 8, data.end() - 4, "IEND")) {
+        const std::size_t firstChunkLength = readFuzzUint32BE(data, 8);
+        if (firstChunkLength <= data.size() - 8 - 2 * 12) {
+            return { "chunks" };
+        }
+        return {};
+    }
+    if (data.size() >= 6 && data.at(0) == 0 && data.at(1) == 0 && (data.at(2) == 1 || data.at(2) == 2) &&
+        data.at(3) == 0) {
+        const std::size_t entryCount = readFuzzUint16LE(data, 4);
+        if (entryCount > 0 && 6 + entryCount * 16 <= data.size()) {
+            return { "images" };
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Measure the average time the fuzz target needs for an input
+ * @param data The input data
+ * @return The average time of a run in nanoseconds (the fastest of several measurements)
+ */
+double measureFuzzInputNanoseconds(const std::vector<uint8_t> &data)
+{
+    double fastest = INFINITY;
+    for (std::size_t repetition = 0; repetition < fuzzTimingRepetitions; repetition++) {
+        std::size_t runs = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto duration = std::chrono::steady_clock::duration {};
+        do {
+            LLVMFuzzerTestOneInput(data.data(), data.size());
+            runs++;
+            duration = std::chrono::steady_clock::now() - start;
+        } while (duration < fuzzTimingMinimumDuration && runs < 10000);
+        fastest = std::min(fastest, std::chrono::duration<double, std::nano>(duration).count() /
+                           static_cast<double>(runs));
+        if (duration > fuzzTimingMaximumRepeatedDuration) {
+            break;
+        }
+    }
+    return fastest;
+}
+
+/**
+ * @brief Fit `time = c * size^exponent` with a least squares fit of the logarithms
+ * @return The exponent (1 = linear growth)
+ */
+double fitFuzzGrowthExponent(const std::vector<double> &sizes, const std::vector<double> &times)
+{
+    double meanLogSize = 0;
+    double meanLogTime = 0;
+    for (std::size_t i = 0; i < sizes.size(); i++) {
+        meanLogSize += std::log(sizes.at(i)) / static_cast<double>(sizes.size());
+        meanLogTime += std::log(times.at(i)) / static_cast<double>(sizes.size());
+    }
+    double covariance = 0;
+    double variance = 0;
+    for (std::size_t i = 0; i < sizes.size(); i++) {
+        covariance += (std::log(sizes.at(i)) - meanLogSize) * (std::log(times.at(i)) - meanLogTime);
+        variance += (std::log(sizes.at(i)) - meanLogSize) * (std::log(sizes.at(i)) - meanLogSize);
+    }
+    return covariance / variance;
+}
+
+struct FuzzInputTiming {
+    std::filesystem::path path;
+    std::string scaling;
+    /** The size of the biggest scaled input */
+    std::size_t size = 0;
+    /** The time per byte of the input */
+    double nanosecondsPerByte = 0;
+    /** The time per byte that was added by scaling the input */
+    double nanosecondsPerAddedByte = 0;
+    /** The growth exponent of the time of the added parts (NaN if they take nearly no time) */
+    double exponent = NAN;
+    bool flagged = false;
+};
+
+/**
+ * @brief Measure how the time of a scaled input grows
+ * @param path The input path
+ * @param data The input data
+ * @param scaling The name of the scaling
+ * @return The timing or nothing if the scaling does not change the input
+ */
+std::optional<FuzzInputTiming> measureFuzzInputScaling(const std::filesystem::path &path,
+        const std::vector<uint8_t> &data, const std::string &scaling)
+{
+    const std::size_t addedBytesPerFactor = scaleFuzzInput(data, scaling, 2).size() - scaleFuzzInput(data, scaling,
+                                            1).size();
+    if (addedBytesPerFactor == 0) {
+        return std::nullopt;
+    }
+    std::size_t factor = std::max<std::size_t>((fuzzScalingMinimumGrowth * data.size() + addedBytesPerFactor - 1) /
+                         addedBytesPerFactor, 2);
+    factor = std::min(factor, std::max<std::size_t>((fuzzScalingMaximumSize / 8) / addedBytesPerFactor, 2));
+    if (scaling == "images") {
+        // The number of directory entries is a 16 bit number
+        const std::size_t entryCount = readFuzzUint16LE(data, 4);
+        factor = std::max<std::size_t>(std::min(factor, 0xFFFF / (entryCount * 8)), 1);
+        if (factor < 2) {
+            return std::nullopt;
+        }
+    }
+
+    FuzzInputTiming timing {};
+    timing.path = path;
+    timing.scaling = scaling;
+    const double nanoseconds = measureFuzzInputNanoseconds(data);
+    timing.nanosecondsPerByte = nanoseconds / static_cast<double>(data.size());
+    // The time of the unchanged part of the input is subtracted so it does not hide the growth
+    std::vector<double> addedSizes {};
+    std::vector<double> addedTimes {};
+    for (std::size_t i = 0; i < 4; i++) {
+        const auto scaledData = scaleFuzzInput(data, scaling, factor << i);
+        addedSizes.push_back(static_cast<double>(scaledData.size() - data.size()));
+        addedTimes.push_back(measureFuzzInputNanoseconds(scaledData) - nanoseconds);
+        timing.size = scaledData.size();
+    }
+    timing.nanosecondsPerAddedByte = std::max(addedTimes.back(), 0.0) / addedSizes.back();
+    // If the added parts are (nearly) free the differences are only noise
+    if (addedTimes.back() >= nanoseconds && *std::min_element(addedTimes.begin(), addedTimes.end()) > 0) {
+        timing.exponent = fitFuzzGrowthExponent(addedSizes, addedTimes);
+    }
+    return timing;
+}
+
+int main(int argc, const char **argv)
+{
+    bool timing = false;
+    double maximumExponent = 1.5;
+    double maximumCostFactor = 20;
+    std::vector<std::string> paths {};
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--timing") {
+            timing = true;
+        } else if (argument.starts_with("--max-exponent=")) {
+            maximumExponent = std::stod(argument.substr(15));
+        } else if (argument.starts_with("--max-cost-factor=")) {
+            maximumCostFactor = std::stod(argument.substr(18));
+        } else {
+            paths.push_back(argument);
+        }
+    }
+    if (paths.empty()) {
+        std::cout << "$ " << argv[0] << " [--timing] [--max-exponent=X] [--max-cost-factor=X] INPUT_FILE_OR_DIRECTORY..."
+                  << std::endl;
+        return -1;
+    }
+
+    std::vector<FuzzInputTiming> timings {};
+    for (const auto &path : collectFuzzInputs(paths)) {
+        const auto data = readFuzzInput(path);
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+        if (!timing) {
+            continue;
+        }
+        for (const auto &scaling : getFuzzInputScalings(data)) {
+            if (auto inputTiming = measureFuzzInputScaling(path, data, scaling)) {
+                inputTiming->flagged = inputTiming->exponent > maximumExponent ||
+                                       inputTiming->nanosecondsPerAddedByte > maximumCostFactor * inputTiming->nanosecondsPerByte;
+                timings.push_back(inputTiming.value());
+            }
+        }
+    }
+    if (!timing) {
+        std::cout << "> All inputs were run" << std::endl;
+        return 0;
+    }
+
+    bool flagged = false;
+    std::cout << "| " << std::left << std::setw(40) << "Input" << " | " << std::setw(8) << "Scaling"
+              << " | " << std::setw(10) << "Max size" << " | " << std::setw(10) << "ns/byte"
+              << " | " << std::setw(14) << "ns/added byte" << " | " << std::setw(8) << "Exponent" << " | Flag |\n";
+    std::cout << "| " << std::string(40, '-') << " | " << std::string(8, '-') << " | " << std::string(10, '-')
+              << " | " << std::string(10, '-') << " | " << std::string(14, '-') << " | " << std::string(8, '-')
+              << " | ---- |\n";
+    for (const auto &inputTiming : timings) {
+        flagged = flagged || inputTiming.flagged;
+        std::cout << "| " << std::setw(40) << inputTiming.path.string() << " | " << std::setw(8) << inputTiming.scaling
+                  << " | " << std::setw(10) << inputTiming.size << " | " << std::setw(10) << std::fixed
+                  << std::setprecision(3) << inputTiming.nanosecondsPerByte << " | " << std::setw(14)
+                  << inputTiming.nanosecondsPerAddedByte << " | " << std::setw(8);
+        if (std::isnan(inputTiming.exponent)) {
+            std::cout << "-";
+        } else {
+            std::cout << inputTiming.exponent;
+        }
+        std::cout << " | " << (inputTiming.flagged ? "X   " : "    ") << " |\n";
+    }
+    std::cout << "> " << timings.size() << " scaled inputs, maximum exponent: " << maximumExponent
+              << ", maximum cost factor: " << maximumCostFactor << std::endl;
+    return flagged ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "aniFileExtractor.hpp"
+#include "simd.hpp"
+
+/** The number of bytes that are displayed in one line of a hex dump */
+constexpr std::size_t hexDumpBytesPerLine = 16;
+/** The number of characters of the hex column ("hh " per byte) */
+constexpr std::size_t hexDumpHexColumnLength = hexDumpBytesPerLine * 3;
+/** The size of the output buffer after which the hex dump is written to the stream */
+constexpr std::size_t hexDumpBufferSize = 1 << 20;
+
+/**
+ * @brief Format up to 16 bytes as hex and ASCII column (reference implementation)
+ * @param bytes The bytes of the line
+ * @param count The number of bytes (missing bytes are displayed as spaces)
+ * @param hex The output for the hex column (48 characters)
+ * @param ascii The output for the ASCII column (16 characters)
+ */
+void formatHexDumpLineReference(const uint8_t *bytes, const std::size_t count, char *hex,
+                                char *ascii)
+{
+    constexpr const char *hexDigits = "0123456789abcdef";
+    for (std::size_t i = 0; i < hexDumpBytesPerLine; i++) {
+        if (i < count) {
+            hex[i * 3] = hexDigits[bytes[i] >> 4];
+            hex[i * 3 + 1] = hexDigits[bytes[i] & 0xF];
+            ascii[i] = bytes[i] >= 0x20 && bytes[i] < 0x7F ? static_cast<char>(bytes[i]) : '.';
+        } else {
+            hex[i * 3] = ' ';
+            hex[i * 3 + 1] = ' ';
+            ascii[i] = ' ';
+        }
+        hex[i * 3 + 2] = ' ';
+    }
+}
+
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+/**
+ * Shuffle masks that move the hex digits of the bytes 0-7 (A) and 8-15 (B) to their position in
+ * the "hh " layout of the 3 output vectors (-128 = zero byte which is later replaced by a space)
+ */
+constexpr auto hexDumpShuffleMasks = [] {
+    std::array<std::array<int8_t, hexDumpHexColumnLength>, 2> masks {};
+    for (std::size_t position = 0; position < hexDumpHexColumnLength; position++) {
+        const std::size_t byte = position / 3;
+        const std::size_t digit = position % 3;
+        masks.at(0).at(position) = -128;
+        masks.at(1).at(position) = -128;
+        if (digit < 2) {
+            masks.at(byte / 8).at(position) = static_cast<int8_t>((byte % 8) * 2 + digit);
+        }
+    }
+    return masks;
+}();
+
+/**
+ * @brief SSSE3 version of formatHexDumpLineReference (only for lines with 16 bytes)
+ */
+ANI_FILE_EXTRACTOR_TARGET("ssse3")
+void formatHexDumpLineSsse3(const uint8_t *bytes, char *hex, char *ascii)
+{
+    const __m128i hexDigits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
+                                            'c', 'd', 'e', 'f');
+    const __m128i lowNibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+    // Every nibble is used as index into the hex digit table
+    const __m128i highDigits = _mm_shuffle_epi8(hexDigits, _mm_and_si128(_mm_srli_epi16(input, 4),
+                               lowNibbleMask));
+    const __m128i lowDigits = _mm_shuffle_epi8(hexDigits, _mm_and_si128(input, lowNibbleMask));
+    const __m128i digitsA = _mm_unpacklo_epi8(highDigits, lowDigits);
+    const __m128i digitsB = _mm_unpackhi_epi8(highDigits, lowDigits);
+    for (std::size_t i = 0; i < 3; i++) {
+        const __m128i maskA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hexDumpShuffleMasks.at(
+                0).data() + i * 16));
+        const __m128i maskB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hexDumpShuffleMasks.at(
+                1).data() + i * 16));
+        const __m128i digits = _mm_or_si128(_mm_shuffle_epi8(digitsA, maskA), _mm_shuffle_epi8(digitsB,
+                                            maskB));
+        // Zero bytes (and only them) are replaced by spaces
+        const __m128i spaces = _mm_and_si128(_mm_cmpeq_epi8(digits, _mm_setzero_si128()), _mm_set1_epi8(' '));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(hex + i * 16), _mm_or_si128(digits, spaces));
+    }
+    // Printable characters are 0x20..0x7E (bytes >= 0x80 are negative in the signed comparison)
+    const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8(0x1F)),
+                                            _mm_cmplt_epi8(input, _mm_set1_epi8(0x7F)));
+    const __m128i characters = _mm_or_si128(_mm_and_si128(printable, input),
+                                            _mm_andnot_si128(printable, _mm_set1_epi8('.')));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(ascii), characters);
+}
+#endif
+
+/**
+ * Every line has the format "{offset}  {16x 'hh '} |{ASCII}|" where the offset is the absolute
+ * decimal position in the data (like the position column of printTable).
+ *
+ * @brief Append the hex dump of a data range to a string buffer
+ * @param buffer The string buffer to which the lines should be appended
+ * @param data The binary data vector
+ * @param start The start position of the range
+ * @param end The end position of the range (exclusive)
+ * @param offsetWidth The minimum number of characters of the offset column
+ */
+void appendHexDump(std::string &buffer, const std::vector<uint8_t> &data, const std::size_t start,
+                   const std::size_t end, const std::size_t offsetWidth)
+{
+    std::array<char, hexDumpHexColumnLength> hex {};
+    std::array<char, hexDumpBytesPerLine> ascii {};
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    const bool useSsse3 = cpuSupportsSsse3();
+#endif
+    for (std::size_t i = start; i < end; i += hexDumpBytesPerLine) {
+        const std::size_t count = std::min(hexDumpBytesPerLine, end - i);
+        const uint8_t *bytes = data.data() + i;
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+        if (useSsse3 && count == hexDumpBytesPerLine) {
+            formatHexDumpLineSsse3(bytes, hex.data(), ascii.data());
+            if constexpr(verifySimd) {
+                std::array<char, hexDumpHexColumnLength> referenceHex {};
+                std::array<char, hexDumpBytesPerLine> referenceAscii {};
+                formatHexDumpLineReference(bytes, count, referenceHex.data(), referenceAscii.data());
+                if (hex != referenceHex || ascii != referenceAscii) {
+                    throw std::runtime_error("Vectorized hex dump line does not match the reference");
+                }
+            }
+        } else {
+            formatHexDumpLineReference(bytes, count, hex.data(), ascii.data());
+        }
+#else
+        formatHexDumpLineReference(bytes, count, hex.data(), ascii.data());
+#endif
+        const auto offset = std::to_string(i);
+        if (offset.size() < offsetWidth) {
+            buffer.append(offsetWidth - offset.size(), ' ');
+        }
+        buffer.append(offset);
+        buffer.append("  ");
+        buffer.append(hex.data(), hex.size());
+        buffer.append("|");
+        buffer.append(ascii.data(), count);
+        buffer.append("|\n");
+    }
+}
+
+/**
+ * @brief Print the hex dump of a data range (the output is written in big blocks)
+ * @param out The output stream
+ * @param data The binary data vector
+ * @param start The start position of the range
+ * @param end The end position of the range (exclusive, clamped to the data size)
+ */
+void printHexDump(std::ostream &out, const std::vector<uint8_t> &data, const std::size_t start,
+                  const std::size_t end)
+{
+    const std::size_t clampedEnd = std::min(end, data.size());
+    const std::size_t offsetWidth = std::max<std::size_t>(8, std::to_string(data.size()).size());
+    std::string buffer {};
+    buffer.reserve(hexDumpBufferSize + 256);
+    for (std::size_t i = start; i < clampedEnd;) {
+        // Append whole lines until the buffer is full
+        const std::size_t linesPerBuffer = hexDumpBufferSize / (offsetWidth + 2 + hexDumpHexColumnLength +
+                                           hexDumpBytesPerLine + 3);
+        const std::size_t blockEnd = std::min(clampedEnd, i + linesPerBuffer * hexDumpBytesPerLine);
+        appendHexDump(buffer, data, i, blockEnd, offsetWidth);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        i = blockEnd;
+    }
+    out.flush();
+}
+
+/**
+ * The selectors can be:
+ * - a FOURCC (for example "icon" or "seq ") which selects all chunks with this id (also in lists)
+ * - "#N" which selects the top level chunk with the number N (see printAniInformation)
+ * - "START-END" which selects the bytes from the position START to END (exclusive)
+ * Chunks are dumped including their chunk id and size so the offsets line up with printTable.
+ *
+ * @brief Print the hex dump of selected chunks or ranges of a file
+ * @param data The binary data vector
+ * @param selectors The selectors (if empty all data is dumped)
+ * @param out The output stream
+ */
+void printHexDumpSelection(const std::vector<uint8_t> &data, const std::vector<std::string> &selectors,
+                           std::ostream &out = std::cout)
+{
+    if (selectors.empty()) {
+        printHexDump(out, data, 0, data.size());
+        return;
+    }
+    const auto chunks = listRiffChunks(data);
+    for (const auto &selector : selectors) {
+        const auto rangeSeparator = selector.find('-');
+        if (rangeSeparator != std::string::npos &&
+            selector.find_first_not_of("0123456789-") == std::string::npos) {
+            // Exactly two numbers are expected ("0-12-5" is rejected instead of being read as "0-12")
+            if (rangeSeparator == 0 || rangeSeparator + 1 == selector.size() ||
+                selector.find('-', rangeSeparator + 1) != std::string::npos) {
+                throw std::runtime_error("Invalid dump range '" + selector + "' (expected START-END)");
+            }
+            const auto start = std::stoull(selector.substr(0, rangeSeparator));
+            const auto end = std::stoull(selector.substr(rangeSeparator + 1));
+            out << "> Range " << start << "-" << end << std::endl;
+            printHexDump(out, data, start, end);
+            continue;
+        }
+        const bool selectIndex = selector.size() > 1 && selector.at(0) == '#' &&
+                                 selector.find_first_not_of("0123456789", 1) == std::string::npos;
+        if (!selectIndex && selector.size() != 4) {
+            throw std::runtime_error("Unknown dump selector '" + selector + "' (expected FOURCC, #N or START-END)");
+        }
+        bool found = false;
+        for (const auto &chunk : chunks) {
+            const bool matches = selectIndex ? chunk.depth == 0 &&
+                                 chunk.topLevelIndex == std::stoull(selector.substr(1)) : chunk.id == selector;
+            if (!matches) {
+                continue;
+            }
+            found = true;
+            out << "> Chunk #" << chunk.topLevelIndex << " '" << chunk.id << "' at " << chunk.start <<
+                      " [length=" << chunk.length << "]" << std::endl;
+            printHexDump(out, data, chunk.start, chunk.dataStart + chunk.length);
+        }
+        if (!found) {
+            out << "> No chunk matches '" << selector << "'" << std::endl;
+        }
+    }
+}
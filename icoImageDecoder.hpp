@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#include "aniFileExtractor.hpp"
+
+/**
+ * A decoded image with straight (not premultiplied) alpha
+ */
+struct RgbaImage {
+    /** Image width in pixels */
+    uint32_t width = 0;
+    /** Image height in pixels */
+    uint32_t height = 0;
+    /** Horizontal hotspot coordinate (only set by cursor images) */
+    uint32_t xHotspot = 0;
+    /** Vertical hotspot coordinate (only set by cursor images) */
+    uint32_t yHotspot = 0;
+    /** Pixels from top to bottom and left to right, each stored as the 4 bytes R, G, B, A */
+    std::vector<uint8_t> pixels = {};
+};
+
+/**
+ * Sources:
+ * - https://en.wikipedia.org/wiki/BMP_file_format
+ * - https://en.wikipedia.org/wiki/ICO_(file_format)
+ *
+ * The image data of an icon directory entry is either a PNG file or a BMP file without the BMP
+ * file header (DIB). A DIB starts with a BITMAPINFOHEADER:
+ *   > {4 Bytes=DWORD=biSize} (40)
+ *   > {4 Bytes=LONG=biWidth}
+ *   > {4 Bytes=LONG=biHeight} (height of the XOR and the AND mask combined)
+ *   > {2 Bytes=WORD=biPlanes}
+ *   > {2 Bytes=WORD=biBitCount} (1, 4, 8, 24 or 32)
+ *   > {4 Bytes=DWORD=biCompression} (0=BI_RGB or 3=BI_BITFIELDS)
+ *   > {4 Bytes=DWORD=biSizeImage}
+ *   > {4 Bytes=LONG=biXPelsPerMeter}
+ *   > {4 Bytes=LONG=biYPelsPerMeter}
+ *   > {4 Bytes=DWORD=biClrUsed}
+ *   > {4 Bytes=DWORD=biClrImportant}
+ * Followed by the color table (only for <= 8 bits per pixel, 4 Bytes BGRX per entry), the XOR
+ * mask (the actual colors) and the 1 bit per pixel AND mask (transparency).
+ * Both masks are stored bottom up and every row is padded to 4 bytes.
+ *
+ * @brief Decode a DIB of an icon directory entry
+ * @param data The `.ico`/`.cur` file binary data vector
+ * @param start The start index of the DIB
+ * @param length The number of bytes of the DIB
+ * @return The decoded image
+ */
+RgbaImage decodeIcoDib(const std::vector<uint8_t> &data, const std::size_t start,
+                       const std::size_t length)
+{
+    if (start > data.size() || length > data.size() - start || length < 40) {
+        throw std::runtime_error("Icon image data is too small to contain a BITMAPINFOHEADER");
+    }
+    const auto headerSize = read32BitUnsignedIntegerLE(data, start);
+    const auto dibWidth = static_cast<int32_t>(read32BitUnsignedIntegerLE(data, start + 4));
+    const auto dibHeight = static_cast<int32_t>(read32BitUnsignedIntegerLE(data, start + 8));
+    const auto bitCount = read16BitUnsignedIntegerLE(data, start + 14);
+    const auto compression = read32BitUnsignedIntegerLE(data, start + 16);
+    const auto colorsUsed = read32BitUnsignedIntegerLE(data, start + 32);
+    if (headerSize < 40 || headerSize > length) {
+        throw std::runtime_error("Unexpected BITMAPINFOHEADER size " + std::to_string(headerSize));
+    }
+    // The DIBs of icons are stored bottom up (positive height) and contain the XOR and the AND mask
+    if (dibWidth <= 0 || dibHeight <= 0 || dibWidth > 0x10000 || dibHeight > 0x20000) {
+        throw std::runtime_error("Unexpected DIB dimensions " + std::to_string(dibWidth) + "x" +
+                                 std::to_string(dibHeight));
+    }
+    if (compression != 0 && !(compression == 3 && bitCount == 32)) {
+        throw std::runtime_error("Compressed DIB data is not supported (compression=" +
+                                 std::to_string(compression) + ")");
+    }
+    if (bitCount != 1 && bitCount != 4 && bitCount != 8 && bitCount != 24 && bitCount != 32) {
+        throw std::runtime_error("DIB bit count " + std::to_string(bitCount) + " is not supported");
+    }
+
+    RgbaImage image {};
+    image.width = static_cast<uint32_t>(dibWidth);
+    image.height = static_cast<uint32_t>(dibHeight / 2);
+    const std::size_t paletteEntries = bitCount > 8 ? 0 : (colorsUsed != 0 ? colorsUsed :
+                                       (1u << bitCount));
+    // The BI_BITFIELDS color masks follow a BITMAPINFOHEADER but are part of the V4/V5 headers
+    const std::size_t paletteStart = start + headerSize + (compression == 3 && headerSize == 40 ? 12 : 0);
+    const std::size_t xorStride = ((image.width * bitCount + 31) / 32) * 4;
+    const std::size_t andStride = ((image.width + 31) / 32) * 4;
+    const std::size_t xorStart = paletteStart + paletteEntries * 4;
+    const std::size_t andStart = xorStart + xorStride * image.height;
+    const std::size_t end = start + length;
+    if (paletteEntries > 256 || andStart > end) {
+        throw std::runtime_error("Unexpected end of icon image data while reading the XOR mask");
+    }
+    // Some 32 bit images omit the AND mask since the alpha channel already contains it
+    const bool hasAndMask = andStart + andStride * image.height <= end;
+    if (!hasAndMask && bitCount != 32) {
+        throw std::runtime_error("Unexpected end of icon image data while reading the AND mask");
+    }
+
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+    bool alphaChannelIsEmpty = true;
+    for (std::size_t y = 0; y < image.height; y++) {
+        // Rows are stored bottom up
+        const uint8_t *row = data.data() + xorStart + (image.height - 1 - y) * xorStride;
+        uint8_t *out = image.pixels.data() + y * image.width * 4;
+        for (std::size_t x = 0; x < image.width; x++, out += 4) {
+            if (bitCount == 32) {
+                out[0] = row[x * 4 + 2];
+                out[1] = row[x * 4 + 1];
+                out[2] = row[x * 4 + 0];
+                out[3] = row[x * 4 + 3];
+                alphaChannelIsEmpty = alphaChannelIsEmpty && out[3] == 0;
+                continue;
+            }
+            if (bitCount == 24) {
+                out[0] = row[x * 3 + 2];
+                out[1] = row[x * 3 + 1];
+                out[2] = row[x * 3 + 0];
+                out[3] = 255;
+                continue;
+            }
+            const std::size_t bitOffset = x * bitCount;
+            const std::size_t index = (row[bitOffset / 8] >> (8 - bitCount - (bitOffset % 8))) &
+                                      ((1u << bitCount) - 1);
+            if (index >= paletteEntries) {
+                throw std::runtime_error("DIB color index " + std::to_string(index) +
+                                         " is outside of the color table");
+            }
+            const uint8_t *color = data.data() + paletteStart + index * 4;
+            out[0] = color[2];
+            out[1] = color[1];
+            out[2] = color[0];
+            out[3] = 255;
+        }
+    }
+    // Images without a usable alpha channel use the AND mask (bit set = transparent)
+    if (hasAndMask && (bitCount != 32 || alphaChannelIsEmpty)) {
+        for (std::size_t y = 0; y < image.height; y++) {
+            const uint8_t *row = data.data() + andStart + (image.height - 1 - y) * andStride;
+            uint8_t *out = image.pixels.data() + y * image.width * 4;
+            for (std::size_t x = 0; x < image.width; x++) {
+                const bool transparent = (row[x / 8] >> (7 - (x % 8))) & 1;
+                out[x * 4 + 3] = transparent ? 0 : 255;
+            }
+        }
+    }
+    return image;
+}
+
+/**
+ * Decode the biggest image of a `.ico`/`.cur` file.
+ * Only DIB image data is supported, PNG compressed image data (mostly used by 256x256 images)
+ * results in an error.
+ *
+ * @brief Decode an icon/cursor file into a RGBA image
+ * @param data The `.ico`/`.cur` file binary data vector
+ * @return The decoded image (with the hotspot if the data is a cursor)
+ */
+RgbaImage decodeIcoImage(const std::vector<uint8_t> &data)
+{
+    if (data.size() < 6) {
+        throw std::runtime_error("Icon data is too small to contain the icon header");
+    }
+    const auto imageType = read16BitUnsignedIntegerLE(data, 2);
+    const auto imageCount = read16BitUnsignedIntegerLE(data, 4);
+    if (imageCount == 0 || 6 + static_cast<std::size_t>(imageCount) * 16 > data.size()) {
+        throw std::runtime_error("Icon data does not contain all directory entries");
+    }
+    // Select the directory entry with the most pixels
+    std::size_t selectedEntry = 6;
+    std::size_t selectedPixelCount = 0;
+    for (std::size_t i = 0; i < imageCount; i++) {
+        const std::size_t entry = 6 + i * 16;
+        const std::size_t width = data.at(entry) == 0 ? 256 : data.at(entry);
+        const std::size_t height = data.at(entry + 1) == 0 ? 256 : data.at(entry + 1);
+        if (width * height > selectedPixelCount) {
+            selectedEntry = entry;
+            selectedPixelCount = width * height;
+        }
+    }
+    const auto imageSize = read32BitUnsignedIntegerLE(data, selectedEntry + 8);
+    const auto imageOffset = read32BitUnsignedIntegerLE(data, selectedEntry + 12);
+    if (static_cast<std::size_t>(imageOffset) + 8 <= data.size() && data.at(imageOffset) == 137 &&
+        data.at(imageOffset + 1) == 'P' && data.at(imageOffset + 2) == 'N' &&
+        data.at(imageOffset + 3) == 'G') {
+        throw std::runtime_error("PNG compressed icon images are not supported");
+    }
+    auto image = decodeIcoDib(data, imageOffset, imageSize);
+    if (imageType == 2) {
+        image.xHotspot = read16BitUnsignedIntegerLE(data, selectedEntry + 4);
+        image.yHotspot = read16BitUnsignedIntegerLE(data, selectedEntry + 6);
+    }
+    if constexpr(debug) {
+        std::cout << "> Decoded icon image (" << image.width << "x" << image.height << ", hotspot="
+                  << image.xHotspot << "," << image.yHotspot << ")" << std::endl;
+    }
+    return image;
+}
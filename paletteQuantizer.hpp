@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#include "aniFileExtractor.hpp"
+#include "icoImageDecoder.hpp"
+
+/**
+ * Open addressing (linear probing) hash table that maps RGBA colors (packed as 32 bit number) to
+ * a 32 bit value
+ */
+class ColorHashTable
+{
+public:
+    ColorHashTable() : keys(1024), values(1024), used(1024, 0) {}
+
+    /**
+     * @brief Get the value of a color (the color is inserted with the value 0 if it is missing)
+     */
+    uint32_t &operator[](const uint32_t color)
+    {
+        std::size_t slot = findSlot(color);
+        if (!used[slot]) {
+            // Keep the load factor below 0.5 so the probe sequences stay short
+            if ((count + 1) * 2 > keys.size()) {
+                grow();
+                slot = findSlot(color);
+            }
+            used[slot] = 1;
+            keys[slot] = color;
+            values[slot] = 0;
+            count++;
+        }
+        return values[slot];
+    }
+    std::size_t size() const
+    {
+        return count;
+    }
+    /**
+     * @brief Call a function for every stored color and its value
+     */
+    template<typename F>
+    void forEach(F function) const
+    {
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (used[i]) {
+                function(keys[i], values[i]);
+            }
+        }
+    }
+
+private:
+    std::size_t findSlot(const uint32_t color) const
+    {
+        std::size_t slot = (color * 0x9E3779B1u) & (keys.size() - 1);
+        while (used[slot] && keys[slot] != color) {
+            slot = (slot + 1) & (keys.size() - 1);
+        }
+        return slot;
+    }
+    void grow()
+    {
+        ColorHashTable bigger {};
+        bigger.keys.assign(keys.size() * 2, 0);
+        bigger.values.assign(keys.size() * 2, 0);
+        bigger.used.assign(keys.size() * 2, 0);
+        forEach([&bigger](const uint32_t color, const uint32_t value) {
+            bigger[color] = value;
+        });
+        *this = std::move(bigger);
+    }
+
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> values;
+    std::vector<uint8_t> used;
+    std::size_t count = 0;
+};
+
+/**
+ * Collection of images that share a color palette
+ */
+struct QuantizedImages {
+    /** The shared palette (4 bytes R, G, B, A per entry, entries with transparency first) */
+    std::vector<std::array<uint8_t, 4>> palette = {};
+    /** The palette index of every pixel of every image (same order as the RGBA pixels) */
+    std::vector<std::vector<uint8_t>> indices = {};
+    /** True if the palette contains all colors of the images without any loss */
+    bool exact = false;
+};
+
+/**
+ * @brief Pack a RGBA pixel into a 32 bit number (all fully transparent pixels are equal)
+ */
+uint32_t packRgbaColor(const uint8_t *pixel)
+{
+    if (pixel[3] == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(pixel[0]) | (static_cast<uint32_t>(pixel[1]) << 8) |
+           (static_cast<uint32_t>(pixel[2]) << 16) | (static_cast<uint32_t>(pixel[3]) << 24);
+}
+
+/**
+ * @brief Squared distance of two RGBA colors (differences in alpha count twice)
+ */
+uint32_t rgbaColorDistance(const std::array<uint8_t, 4> &a, const std::array<uint8_t, 4> &b)
+{
+    uint32_t distance = 0;
+    for (std::size_t channel = 0; channel < 4; channel++) {
+        const int difference = static_cast<int>(a.at(channel)) - static_cast<int>(b.at(channel));
+        distance += static_cast<uint32_t>(difference * difference) * (channel == 3 ? 2 : 1);
+    }
+    return distance;
+}
+
+/**
+ * A color of the histogram with the number of pixels that use it
+ */
+struct HistogramColor {
+    std::array<uint8_t, 4> color;
+    uint32_t pixelCount;
+};
+
+/**
+ * Median cut: Start with one box that contains all colors and split the box with the biggest color
+ * channel range at the (pixel count weighted) median of that channel until there are enough boxes.
+ * The palette contains the weighted average of every box and is then refined with a few k-means
+ * iterations.
+ * Fully transparent pixels always get their own palette entry.
+ *
+ * @brief Create a palette for a color histogram that has more colors than palette entries
+ * @param histogram All colors with their pixel count
+ * @param maxColors The maximum number of palette entries
+ * @return The palette
+ */
+std::vector<std::array<uint8_t, 4>> createMedianCutPalette(std::vector<HistogramColor> histogram,
+                                 const std::size_t maxColors)
+{
+    constexpr std::size_t kMeansIterations = 2;
+    std::vector<std::array<uint8_t, 4>> palette {};
+    const auto transparentColor = std::find_if(histogram.begin(), histogram.end(),
+    [](const HistogramColor & entry) {
+        return entry.color.at(3) == 0;
+    });
+    if (transparentColor != histogram.end()) {
+        palette.push_back({ 0, 0, 0, 0 });
+        histogram.erase(transparentColor);
+    }
+
+    struct Box {
+        std::size_t begin;
+        std::size_t end;
+        /** The color channel with the biggest range */
+        std::size_t channel;
+        /** The range of this color channel */
+        int range;
+    };
+    const auto createBox = [&histogram](const std::size_t begin, const std::size_t end) {
+        std::array<uint8_t, 4> minimum { 255, 255, 255, 255 };
+        std::array<uint8_t, 4> maximum {};
+        for (std::size_t i = begin; i < end; i++) {
+            for (std::size_t channel = 0; channel < 4; channel++) {
+                minimum.at(channel) = std::min(minimum.at(channel), histogram[i].color.at(channel));
+                maximum.at(channel) = std::max(maximum.at(channel), histogram[i].color.at(channel));
+            }
+        }
+        Box box { begin, end, 0, 0 };
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            const int range = static_cast<int>(maximum.at(channel)) - static_cast<int>(minimum.at(channel));
+            if (range > box.range) {
+                box.channel = channel;
+                box.range = range;
+            }
+        }
+        return box;
+    };
+    std::vector<Box> boxes { createBox(0, histogram.size()) };
+    while (palette.size() + boxes.size() < maxColors) {
+        // Split the box with the biggest range
+        std::size_t bestBox = 0;
+        for (std::size_t i = 1; i < boxes.size(); i++) {
+            if (boxes.at(i).range > boxes.at(bestBox).range) {
+                bestBox = i;
+            }
+        }
+        if (boxes.at(bestBox).range == 0) {
+            break;
+        }
+        const Box box = boxes.at(bestBox);
+        std::sort(histogram.begin() + box.begin, histogram.begin() + box.end,
+        [&box](const HistogramColor & a, const HistogramColor & b) {
+            return a.color.at(box.channel) < b.color.at(box.channel);
+        });
+        uint64_t boxPixelCount = 0;
+        for (std::size_t i = box.begin; i < box.end; i++) {
+            boxPixelCount += histogram[i].pixelCount;
+        }
+        std::size_t median = box.begin + 1;
+        uint64_t pixelCount = histogram[box.begin].pixelCount;
+        while (median < box.end - 1 && pixelCount * 2 < boxPixelCount) {
+            pixelCount += histogram[median].pixelCount;
+            median++;
+        }
+        boxes.at(bestBox) = createBox(box.begin, median);
+        boxes.push_back(createBox(median, box.end));
+    }
+
+    const std::size_t firstBoxEntry = palette.size();
+    for (const auto &box : boxes) {
+        std::array<uint64_t, 4> sum {};
+        uint64_t pixelCount = 0;
+        for (std::size_t i = box.begin; i < box.end; i++) {
+            for (std::size_t channel = 0; channel < 4; channel++) {
+                sum.at(channel) += static_cast<uint64_t>(histogram[i].color.at(channel)) * histogram[i].pixelCount;
+            }
+            pixelCount += histogram[i].pixelCount;
+        }
+        std::array<uint8_t, 4> average {};
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            average.at(channel) = static_cast<uint8_t>((sum.at(channel) + pixelCount / 2) / std::max<uint64_t>
+                                  (pixelCount, 1));
+        }
+        palette.push_back(average);
+    }
+
+    // Refine the box colors with k-means (the transparent entry stays fixed)
+    for (std::size_t iteration = 0; iteration < kMeansIterations; iteration++) {
+        std::vector<std::array<uint64_t, 5>> sums(palette.size());
+        for (const auto &entry : histogram) {
+            std::size_t nearest = firstBoxEntry;
+            uint32_t nearestDistance = UINT32_MAX;
+            for (std::size_t i = firstBoxEntry; i < palette.size(); i++) {
+                const auto distance = rgbaColorDistance(entry.color, palette.at(i));
+                if (distance < nearestDistance) {
+                    nearest = i;
+                    nearestDistance = distance;
+                }
+            }
+            for (std::size_t channel = 0; channel < 4; channel++) {
+                sums.at(nearest).at(channel) += static_cast<uint64_t>(entry.color.at(channel)) * entry.pixelCount;
+            }
+            sums.at(nearest).at(4) += entry.pixelCount;
+        }
+        for (std::size_t i = firstBoxEntry; i < palette.size(); i++) {
+            const auto pixelCount = sums.at(i).at(4);
+            for (std::size_t channel = 0; channel < 4 && pixelCount > 0; channel++) {
+                palette.at(i).at(channel) = static_cast<uint8_t>((sums.at(i).at(channel) + pixelCount / 2) /
+                                            pixelCount);
+            }
+        }
+    }
+    return palette;
+}
+
+/**
+ * The colors of all images are counted exactly with a hash table.
+ * If there are not more colors than palette entries the palette contains exactly these colors,
+ * otherwise a median cut/k-means palette is created and every pixel uses the nearest entry.
+ * In both cases one palette is shared by all images.
+ *
+ * @brief Quantize the colors of multiple images to a shared palette
+ * @param images The images (for example all frames of a cursor)
+ * @param maxColors The maximum number of palette entries (1..256)
+ * @return The palette and the palette indices of all pixels
+ */
+QuantizedImages quantizeImages(const std::vector<RgbaImage> &images, const std::size_t maxColors = 256)
+{
+    if (maxColors == 0 || maxColors > 256) {
+        throw std::runtime_error("The palette size must be between 1 and 256");
+    }
+    ColorHashTable colorTable {};
+    for (const auto &image : images) {
+        for (std::size_t i = 0; i < image.pixels.size(); i += 4) {
+            colorTable[packRgbaColor(image.pixels.data() + i)] += 1;
+        }
+    }
+    std::vector<HistogramColor> histogram {};
+    histogram.reserve(colorTable.size());
+    colorTable.forEach([&histogram](const uint32_t color, const uint32_t pixelCount) {
+        histogram.push_back({ { static_cast<uint8_t>(color), static_cast<uint8_t>(color >> 8), static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 24) }, pixelCount });
+    });
+
+    QuantizedImages quantizedImages {};
+    quantizedImages.exact = histogram.size() <= maxColors;
+    if (quantizedImages.exact) {
+        for (const auto &entry : histogram) {
+            quantizedImages.palette.push_back(entry.color);
+        }
+    } else {
+        quantizedImages.palette = createMedianCutPalette(histogram, maxColors);
+    }
+    // Entries with transparency first so the PNG tRNS chunk is as short as possible
+    std::stable_sort(quantizedImages.palette.begin(), quantizedImages.palette.end(),
+    [](const std::array<uint8_t, 4> &a, const std::array<uint8_t, 4> &b) {
+        return (a.at(3) < 255) && (b.at(3) == 255);
+    });
+
+    // Map every color to its (nearest) palette entry
+    for (const auto &entry : histogram) {
+        std::size_t nearest = 0;
+        uint32_t nearestDistance = UINT32_MAX;
+        for (std::size_t i = 0; i < quantizedImages.palette.size() && nearestDistance > 0; i++) {
+            const auto distance = rgbaColorDistance(entry.color, quantizedImages.palette.at(i));
+            if (distance < nearestDistance) {
+                nearest = i;
+                nearestDistance = distance;
+            }
+        }
+        colorTable[packRgbaColor(entry.color.data())] = static_cast<uint32_t>(nearest);
+    }
+    for (const auto &image : images) {
+        std::vector<uint8_t> indices(image.pixels.size() / 4);
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            indices[i] = static_cast<uint8_t>(colorTable[packRgbaColor(image.pixels.data() + i * 4)]);
+        }
+        quantizedImages.indices.push_back(std::move(indices));
+    }
+    if constexpr(debug) {
+        std::cout << "> Quantized " << histogram.size() << " colors " << (quantizedImages.exact ? "exactly" :
+                  "approximately") << " to a palette with " << quantizedImages.palette.size() << " entries" << std::endl;
+    }
+    return quantizedImages;
+}
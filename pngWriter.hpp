@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+/**
+ * Sources:
+ * - http://www.libpng.org/pub/png/spec/1.2/PNG-Structure.html
+ * - https://www.rfc-editor.org/rfc/rfc1950 (ZLIB)
+ * - https://www.rfc-editor.org/rfc/rfc1951 (DEFLATE)
+ *
+ * Everything that is necessary to write PNG files without any external library:
+ * the CRC of the chunks, the row filters and a small DEFLATE compressor that uses LZ77 with a
+ * bounded hash chain and the fixed Huffman codes (so the compression time is linear).
+ */
+
+/**
+ * @brief Append a 32 Bit unsigned number as 4 big endian bytes (PNG byte order)
+ */
+void append32BitUnsignedIntegerBE(std::vector<uint8_t> &data, const uint32_t number)
+{
+    data.push_back(static_cast<uint8_t>(number >> 24));
+    data.push_back(static_cast<uint8_t>(number >> 16));
+    data.push_back(static_cast<uint8_t>(number >> 8));
+    data.push_back(static_cast<uint8_t>(number));
+}
+
+/**
+ * @brief Calculate the CRC-32 (polynomial 0xEDB88320) that is used by PNG chunks
+ */
+uint32_t calculateCrc32(const uint8_t *data, const std::size_t length, uint32_t crc = 0)
+{
+    static const auto table = [] {
+        std::array<uint32_t, 256> crcTable {};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crcTable.at(i) = c;
+        }
+        return crcTable;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Calculate the Adler-32 checksum that is used by ZLIB streams
+ */
+uint32_t calculateAdler32(const std::vector<uint8_t> &data)
+{
+    uint32_t a = 1;
+    uint32_t b = 0;
+    std::size_t i = 0;
+    while (i < data.size()) {
+        // 5552 is the biggest block size for which b does not overflow before the modulo
+        const std::size_t blockEnd = std::min(data.size(), i + 5552);
+        for (; i < blockEnd; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+/**
+ * Writes bits starting with the least significant bit of each byte (DEFLATE bit order)
+ */
+class DeflateBitWriter
+{
+public:
+    explicit DeflateBitWriter(std::vector<uint8_t> &data) : data(data) {}
+
+    void writeBits(const uint32_t bits, const int bitCount)
+    {
+        buffer |= static_cast<uint64_t>(bits) << bufferedBits;
+        bufferedBits += bitCount;
+        while (bufferedBits >= 8) {
+            data.push_back(static_cast<uint8_t>(buffer));
+            buffer >>= 8;
+            bufferedBits -= 8;
+        }
+    }
+    /** Huffman codes are stored starting with the most significant bit */
+    void writeHuffmanCode(const uint32_t code, const int bitCount)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < bitCount; i++) {
+            reversed |= ((code >> i) & 1) << (bitCount - 1 - i);
+        }
+        writeBits(reversed, bitCount);
+    }
+    void flush()
+    {
+        if (bufferedBits > 0) {
+            data.push_back(static_cast<uint8_t>(buffer));
+        }
+        buffer = 0;
+        bufferedBits = 0;
+    }
+
+private:
+    std::vector<uint8_t> &data;
+    uint64_t buffer = 0;
+    int bufferedBits = 0;
+};
+
+/**
+ * @brief Write a literal/length symbol with the fixed Huffman code of DEFLATE
+ */
+void writeFixedHuffmanLiteral(DeflateBitWriter &writer, const uint32_t symbol)
+{
+    if (symbol <= 143) {
+        writer.writeHuffmanCode(0x30 + symbol, 8);
+    } else if (symbol <= 255) {
+        writer.writeHuffmanCode(0x190 + symbol - 144, 9);
+    } else if (symbol <= 279) {
+        writer.writeHuffmanCode(symbol - 256, 7);
+    } else {
+        writer.writeHuffmanCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+/**
+ * @brief Write a LZ77 match (length 3..258, distance 1..32768) with the fixed Huffman codes
+ */
+void writeFixedHuffmanMatch(DeflateBitWriter &writer, const uint32_t length, const uint32_t distance)
+{
+    static constexpr std::array<uint16_t, 29> lengthBase { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23,
+                                                           27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static constexpr std::array<uint8_t, 29> lengthExtraBits { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                               3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static constexpr std::array<uint16_t, 30> distanceBase { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97,
+                                                             129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static constexpr std::array<uint8_t, 30> distanceExtraBits { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                                                 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    std::size_t lengthCode = lengthBase.size() - 1;
+    while (lengthBase.at(lengthCode) > length) {
+        lengthCode--;
+    }
+    writeFixedHuffmanLiteral(writer, static_cast<uint32_t>(257 + lengthCode));
+    writer.writeBits(length - lengthBase.at(lengthCode), lengthExtraBits.at(lengthCode));
+    std::size_t distanceCode = distanceBase.size() - 1;
+    while (distanceBase.at(distanceCode) > distance) {
+        distanceCode--;
+    }
+    writer.writeHuffmanCode(static_cast<uint32_t>(distanceCode), 5);
+    writer.writeBits(distance - distanceBase.at(distanceCode), distanceExtraBits.at(distanceCode));
+}
+
+/**
+ * @brief Compress data into a ZLIB stream (a single DEFLATE block with the fixed Huffman codes)
+ * @param data The uncompressed data
+ * @return The ZLIB stream
+ */
+std::vector<uint8_t> compressZlib(const std::vector<uint8_t> &data)
+{
+    constexpr std::size_t windowSize = 32768;
+    constexpr std::size_t hashSize = 1 << 15;
+    constexpr std::size_t maxChainLength = 32;
+    constexpr std::size_t minMatchLength = 3;
+    constexpr std::size_t maxMatchLength = 258;
+
+    std::vector<uint8_t> out {};
+    out.reserve(data.size() / 2 + 64);
+    // ZLIB header: deflate with a 32K window and the fastest compression level
+    out.push_back(0x78);
+    out.push_back(0x01);
+    DeflateBitWriter writer(out);
+    // BFINAL=1, BTYPE=01 (fixed Huffman codes)
+    writer.writeBits(1, 1);
+    writer.writeBits(1, 2);
+
+    std::vector<int64_t> head(hashSize, -1);
+    std::vector<int64_t> previous(windowSize, -1);
+    const auto hashAt = [&data](const std::size_t i) {
+        return ((static_cast<uint32_t>(data[i]) << 10) ^ (static_cast<uint32_t>(data[i + 1]) << 5) ^
+                data[i + 2]) & (hashSize - 1);
+    };
+    const auto insertHash = [&](const std::size_t i) {
+        if (i + minMatchLength <= data.size()) {
+            const auto hash = hashAt(i);
+            previous[i % windowSize] = head[hash];
+            head[hash] = static_cast<int64_t>(i);
+        }
+    };
+
+    std::size_t i = 0;
+    while (i < data.size()) {
+        std::size_t bestLength = 0;
+        std::size_t bestDistance = 0;
+        if (i + minMatchLength <= data.size()) {
+            const std::size_t maxLength = std::min(maxMatchLength, data.size() - i);
+            int64_t candidate = head[hashAt(i)];
+            for (std::size_t chain = 0; chain < maxChainLength && candidate >= 0 &&
+                 i - static_cast<std::size_t>(candidate) <= windowSize; chain++) {
+                const auto candidatePosition = static_cast<std::size_t>(candidate);
+                std::size_t length = 0;
+                while (length < maxLength && data[candidatePosition + length] == data[i + length]) {
+                    length++;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = i - candidatePosition;
+                    if (length == maxLength) {
+                        break;
+                    }
+                }
+                const auto next = previous[candidatePosition % windowSize];
+                // Older entries of the ring buffer were overwritten
+                if (next >= candidate) {
+                    break;
+                }
+                candidate = next;
+            }
+        }
+        if (bestLength >= minMatchLength) {
+            writeFixedHuffmanMatch(writer, static_cast<uint32_t>(bestLength),
+                                   static_cast<uint32_t>(bestDistance));
+            for (std::size_t j = 0; j < bestLength; j++) {
+                insertHash(i + j);
+            }
+            i += bestLength;
+        } else {
+            writeFixedHuffmanLiteral(writer, data[i]);
+            insertHash(i);
+            i += 1;
+        }
+    }
+    // End of block
+    writeFixedHuffmanLiteral(writer, 256);
+    writer.flush();
+    const auto adler = calculateAdler32(data);
+    append32BitUnsignedIntegerBE(out, adler);
+    return out;
+}
+
+/**
+ * @brief Paeth predictor of the PNG row filter type 4
+ */
+uint8_t paethPredictor(const int a, const int b, const int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+/**
+ * Every row is filtered with the filter type (None, Sub, Up, Average, Paeth) that results in the
+ * smallest sum of absolute differences (the heuristic that is recommended by the PNG specification).
+ *
+ * @brief Filter and compress image rows into PNG image data (the content of IDAT/fdAT chunks)
+ * @param pixels Pointer to the first pixel of the image
+ * @param stride The number of bytes between the start of two rows in pixels
+ * @param width The image width in pixels
+ * @param height The image height in pixels
+ * @param bytesPerPixel The number of bytes per pixel (4 for RGBA, 1 for indexed colors)
+ * @return The ZLIB compressed image data
+ */
+std::vector<uint8_t> encodePngImageData(const uint8_t *pixels, const std::size_t stride,
+                                        const std::size_t width, const std::size_t height, const std::size_t bytesPerPixel)
+{
+    const std::size_t rowLength = width * bytesPerPixel;
+    std::vector<uint8_t> filtered((rowLength + 1) * height);
+    std::vector<uint8_t> candidate(rowLength);
+    const std::vector<uint8_t> zeroRow(rowLength, 0);
+    for (std::size_t y = 0; y < height; y++) {
+        const uint8_t *row = pixels + y * stride;
+        const uint8_t *above = y > 0 ? pixels + (y - 1) * stride : zeroRow.data();
+        uint8_t *out = filtered.data() + y * (rowLength + 1);
+        uint64_t bestSum = UINT64_MAX;
+        for (uint8_t filterType = 0; filterType < 5; filterType++) {
+            uint64_t sum = 0;
+            for (std::size_t x = 0; x < rowLength; x++) {
+                const int left = x >= bytesPerPixel ? row[x - bytesPerPixel] : 0;
+                const int upperLeft = x >= bytesPerPixel ? above[x - bytesPerPixel] : 0;
+                int predictor = 0;
+                switch (filterType) {
+                    case 1:
+                        predictor = left;
+                        break;
+                    case 2:
+                        predictor = above[x];
+                        break;
+                    case 3:
+                        predictor = (left + above[x]) / 2;
+                        break;
+                    case 4:
+                        predictor = paethPredictor(left, above[x], upperLeft);
+                        break;
+                    default:
+                        break;
+                }
+                candidate[x] = static_cast<uint8_t>(row[x] - predictor);
+                sum += static_cast<uint64_t>(std::abs(static_cast<int8_t>(candidate[x])));
+            }
+            if (sum < bestSum) {
+                bestSum = sum;
+                out[0] = filterType;
+                std::copy(candidate.begin(), candidate.end(), out + 1);
+            }
+        }
+    }
+    return compressZlib(filtered);
+}
+
+/**
+ * @brief Append a PNG chunk (length, type, data and CRC of type and data)
+ * @param png The PNG file data to which the chunk should be appended
+ * @param chunkType The 4 character chunk type
+ * @param chunkData The chunk data
+ */
+void appendPngChunk(std::vector<uint8_t> &png, const std::string &chunkType,
+                    const std::vector<uint8_t> &chunkData)
+{
+    if (chunkType.size() != 4 || chunkData.size() > 0x7FFFFFFF) {
+        throw std::runtime_error("Invalid PNG chunk '" + chunkType + "'");
+    }
+    append32BitUnsignedIntegerBE(png, static_cast<uint32_t>(chunkData.size()));
+    const std::size_t crcStart = png.size();
+    png.insert(png.end(), chunkType.begin(), chunkType.end());
+    png.insert(png.end(), chunkData.begin(), chunkData.end());
+    append32BitUnsignedIntegerBE(png, calculateCrc32(png.data() + crcStart, png.size() - crcStart));
+}
+
+/**
+ * @brief Append the 8 byte PNG signature
+ */
+void appendPngSignature(std::vector<uint8_t> &png)
+{
+    png.insert(png.end(), { 137, 'P', 'N', 'G', 13, 10, 26, 10 });
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "aniFileExtractor.hpp"
+#include "simd.hpp"
+
+/**
+ * X11 cursors store every pixel as a 32 bit ARGB number with premultiplied alpha which means that
+ * every color channel c is replaced by round(c * a / 255).
+ * The output is written as little endian bytes (B, G, R, A) which is the format of Xcursor files.
+ *
+ * @brief Reference (scalar) conversion of RGBA pixels to premultiplied ARGB32 pixels
+ * @param rgba The input pixels (4 bytes R, G, B, A per pixel)
+ * @param argb The output pixels (4 bytes B, G, R, A per pixel)
+ * @param pixelCount The number of pixels to convert
+ */
+void premultiplyRgbaToArgbReference(const uint8_t *rgba, uint8_t *argb,
+                                    const std::size_t pixelCount)
+{
+    for (std::size_t i = 0; i < pixelCount * 4; i += 4) {
+        const unsigned int alpha = rgba[i + 3];
+        argb[i + 0] = static_cast<uint8_t>((rgba[i + 2] * alpha + 127) / 255);
+        argb[i + 1] = static_cast<uint8_t>((rgba[i + 1] * alpha + 127) / 255);
+        argb[i + 2] = static_cast<uint8_t>((rgba[i + 0] * alpha + 127) / 255);
+        argb[i + 3] = static_cast<uint8_t>(alpha);
+    }
+}
+
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+/**
+ * The vectorized kernels widen the channels to 16 bit, multiply them with the alpha of their pixel
+ * (the alpha channel itself is multiplied with 255) and divide the products by 255 with
+ * (x + 128 + ((x + 128) >> 8)) >> 8 which is exactly round(x / 255) for x <= 255 * 255.
+ */
+ANI_FILE_EXTRACTOR_TARGET("sse4.1")
+__m128i premultiply16BitChannelsSse41(const __m128i channels)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, 0xFF), 0xFF);
+    alpha = _mm_blend_epi16(alpha, _mm_set1_epi16(255), 0x88);
+    const __m128i product = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+
+/**
+ * @brief SSE4.1 conversion of RGBA pixels to premultiplied ARGB32 pixels (4 pixels per iteration)
+ * @return The number of converted pixels (the remaining pixels need to be converted separately)
+ */
+ANI_FILE_EXTRACTOR_TARGET("sse4.1")
+std::size_t premultiplyRgbaToArgbSse41(const uint8_t *rgba, uint8_t *argb,
+                                       const std::size_t pixelCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbaToBgra = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    std::size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 4));
+        const __m128i low = premultiply16BitChannelsSse41(_mm_unpacklo_epi8(pixels, zero));
+        const __m128i high = premultiply16BitChannelsSse41(_mm_unpackhi_epi8(pixels, zero));
+        const __m128i result = _mm_shuffle_epi8(_mm_packus_epi16(low, high), rgbaToBgra);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(argb + i * 4), result);
+    }
+    return i;
+}
+
+ANI_FILE_EXTRACTOR_TARGET("avx2")
+__m256i premultiply16BitChannelsAvx2(const __m256i channels)
+{
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(channels, 0xFF), 0xFF);
+    alpha = _mm256_blend_epi16(alpha, _mm256_set1_epi16(255), 0x88);
+    const __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(channels, alpha),
+                            _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+}
+
+/**
+ * @brief AVX2 conversion of RGBA pixels to premultiplied ARGB32 pixels (8 pixels per iteration)
+ * @return The number of converted pixels (the remaining pixels need to be converted separately)
+ */
+ANI_FILE_EXTRACTOR_TARGET("avx2")
+std::size_t premultiplyRgbaToArgbAvx2(const uint8_t *rgba, uint8_t *argb,
+                                      const std::size_t pixelCount)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rgbaToBgra = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                               2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    std::size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rgba + i * 4));
+        // Unpacking and packing both work per 128 bit lane so the pixel order is preserved
+        const __m256i low = premultiply16BitChannelsAvx2(_mm256_unpacklo_epi8(pixels, zero));
+        const __m256i high = premultiply16BitChannelsAvx2(_mm256_unpackhi_epi8(pixels, zero));
+        const __m256i result = _mm256_shuffle_epi8(_mm256_packus_epi16(low, high), rgbaToBgra);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(argb + i * 4), result);
+    }
+    return i;
+}
+#endif
+
+/**
+ * Uses the best vectorized kernel that the CPU supports (AVX2, SSE4.1) and the reference
+ * implementation for the remaining pixels or if no vectorized kernel is available.
+ * With -DANI_FILE_EXTRACTOR_VERIFY_SIMD=1 the result is additionally compared to the reference
+ * implementation.
+ *
+ * @brief Convert RGBA pixels to premultiplied ARGB32 pixels
+ * @param rgba The input pixels (4 bytes R, G, B, A per pixel)
+ * @param argb The output pixels (4 bytes B, G, R, A per pixel)
+ * @param pixelCount The number of pixels to convert
+ */
+void premultiplyRgbaToArgb(const uint8_t *rgba, uint8_t *argb, const std::size_t pixelCount)
+{
+    std::size_t convertedPixels = 0;
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    if (cpuSupportsAvx2()) {
+        convertedPixels = premultiplyRgbaToArgbAvx2(rgba, argb, pixelCount);
+    } else if (cpuSupportsSse41()) {
+        convertedPixels = premultiplyRgbaToArgbSse41(rgba, argb, pixelCount);
+    }
+#endif
+    premultiplyRgbaToArgbReference(rgba + convertedPixels * 4, argb + convertedPixels * 4,
+                                   pixelCount - convertedPixels);
+    if constexpr(verifySimd) {
+        std::vector<uint8_t> reference(pixelCount * 4);
+        premultiplyRgbaToArgbReference(rgba, reference.data(), pixelCount);
+        if (std::memcmp(reference.data(), argb, reference.size()) != 0) {
+            throw std::runtime_error("Vectorized premultiplied ARGB conversion does not match the reference");
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
+#include <span>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -41,7 +43,7 @@ using PrintTableColumn =
 
 std::string tableColumnDataToStr(const std::size_t start, const std::size_t size,
                                  const PrintTableColumnDataType dataType,
-                                 const std::vector<std::uint8_t> &dataRaw)
+                                 const std::span<const std::uint8_t> dataRaw)
 {
     std::stringstream ss {};
     if (dataType == PrintTableColumnDataType::HIDE) {
@@ -50,7 +52,7 @@ std::string tableColumnDataToStr(const std::size_t start, const std::size_t size
     if (dataType != PrintTableColumnDataType::NONE) {
         ss << "'";
         for (std::size_t i = start; i < start + size; i++) {
-            ss << static_cast<int>(dataRaw.at(i)) << " ";;
+            ss << static_cast<int>(readByte(dataRaw, i)) << " ";;
         }
         if (dataRaw.size() > 0) {
             ss.seekp(-1, std::ios_base::end);
@@ -78,10 +80,10 @@ std::string tableColumnDataToStr(const std::size_t start, const std::size_t size
     } else {
         for (std::size_t i = start; i < start + size; i++) {
             if (dataType == PrintTableColumnDataType::NONE || dataType == PrintTableColumnDataType::INT) {
-                ss << static_cast<int>(dataRaw.at(i)) << " ";
+                ss << static_cast<int>(readByte(dataRaw, i)) << " ";
             }
             if (dataType == PrintTableColumnDataType::CHAR) {
-                ss << static_cast<char>(dataRaw.at(i)) << " ";
+                ss << static_cast<char>(readByte(dataRaw, i)) << " ";
             }
         }
         if (dataRaw.size() > 0) {
@@ -115,7 +117,8 @@ std::string tableColumnDataToStr(const std::size_t start, const std::size_t size
     return ss.str();
 }
 
-void printTable(const std::vector<PrintTableColumn> &columns, const std::vector<std::uint8_t> &data)
+void printTable(const std::vector<PrintTableColumn> &columns, const std::span<const std::uint8_t> data,
+                std::ostream &out = std::cout)
 {
     const std::tuple<std::string, std::string, std::string, std::string> header {"Position", "Size", "Purpose", "Data" };
     // Calculate padding information
@@ -130,21 +133,21 @@ void printTable(const std::vector<PrintTableColumn> &columns, const std::vector<
         maxLengthData = std::max(maxLengthData, tableColumnDataToStr(std::get<0>(column),
                                  std::get<1>(column), std::get<3>(column), data).length());
     }
-    std::cout << "| " << padRight(std::get<0>(header), maxLengthPosition, ' ')
-              << " | " << padRight(std::get<1>(header), maxLengthSize, ' ')
-              << " | " << padRight(std::get<2>(header), maxLengthPurpose, ' ')
-              << " | " << padRight(std::get<3>(header), maxLengthData, ' ') << " |" << std::endl;
-    std::cout << "| " << padRight("", maxLengthPosition, '-')
-              << " | " << padRight("", maxLengthSize, '-')
-              << " | " << padRight("", maxLengthPurpose, '-')
-              << " | " << padRight("", maxLengthData, '-') << " |" << std::endl;
+    out << "| " << padRight(std::get<0>(header), maxLengthPosition, ' ')
+        << " | " << padRight(std::get<1>(header), maxLengthSize, ' ')
+        << " | " << padRight(std::get<2>(header), maxLengthPurpose, ' ')
+        << " | " << padRight(std::get<3>(header), maxLengthData, ' ') << " |" << std::endl;
+    out << "| " << padRight("", maxLengthPosition, '-')
+        << " | " << padRight("", maxLengthSize, '-')
+        << " | " << padRight("", maxLengthPurpose, '-')
+        << " | " << padRight("", maxLengthData, '-') << " |" << std::endl;
     for (const auto &column : columns) {
-        std::cout << "| " << padRightNumber(std::get<0>(column), maxLengthPosition, ' ')
-                  << " | " << padRightNumber(std::get<1>(column), maxLengthSize, ' ')
-                  << " | " << padRight(std::get<2>(column), maxLengthPurpose, ' ')
-                  << " | " << padRight(tableColumnDataToStr(std::get<0>(column), std::get<1>(column),
-                                       std::get<3>(column), data), maxLengthData,
-                                       ' ') << " |" << std::endl;
+        out << "| " << padRightNumber(std::get<0>(column), maxLengthPosition, ' ')
+            << " | " << padRightNumber(std::get<1>(column), maxLengthSize, ' ')
+            << " | " << padRight(std::get<2>(column), maxLengthPurpose, ' ')
+            << " | " << padRight(tableColumnDataToStr(std::get<0>(column), std::get<1>(column),
+                                 std::get<3>(column), data), maxLengthData,
+                                 ' ') << " |" << std::endl;
     }
 }
 
@@ -163,17 +166,18 @@ void printTable(const std::vector<PrintTableColumn> &columns, const std::vector<
  *   > {chunkLength Bytes=chunkData}
  *   > {4 Bytes=crc}
  */
-void printPngInformation(const std::vector<uint8_t> &data, const std::size_t start)
+void printPngInformation(const std::vector<uint8_t> &data, const std::size_t start,
+                         std::ostream &out = std::cout)
 {
     if (start + 8 >= data.size()) {
-        std::cout << "> data too small to contain png signature!" << std::endl;
+        out << "> data too small to contain png signature!" << std::endl;
         return;
     }
     if (!(data.at(start + 0) == 137 && data.at(start + 1) == 'P' && data.at(start + 2) == 'N' &&
           data.at(start + 3) == 'G' &&
           data.at(start + 4) == 13 && data.at(start + 5) == 10 && data.at(start + 6) == 26 &&
           data.at(start + 7) == 10)) {
-        std::cout << "> png signature (the leading 8 bytes) is incorrect!" << std::endl;
+        out << "> png signature (the leading 8 bytes) is incorrect!" << std::endl;
         return;
     }
 
@@ -191,20 +195,22 @@ void printPngInformation(const std::vector<uint8_t> &data, const std::size_t sta
             table.emplace_back(std::tuple{ i, 4, "chunk type", PrintTableColumnDataType::CHAR });
             i += 4;
             if (chunkSize > 0) {
-                table.emplace_back(std::tuple{ i, chunkSize, "chunk data", PrintTableColumnDataType::HIDE });
-                i += chunkSize;
+                // The chunk size is not trusted so the chunk data ends at the latest at the end of the data
+                const std::size_t chunkDataSize = std::min<std::size_t>(chunkSize, data.size() - i);
+                table.emplace_back(std::tuple{ i, chunkDataSize, "chunk data", PrintTableColumnDataType::HIDE });
+                i += chunkDataSize;
             }
             if (i + 4 < data.size()) {
                 table.emplace_back(std::tuple{ i, 4, "crc (Cyclic Redundancy Check)", PrintTableColumnDataType::NONE });
                 i += 4;
             } else if (chunkDataType != "IEND") {
-                std::cout << "crc value missing since the data is too short" << std::endl;
+                out << "crc value missing since the data is too short" << std::endl;
             }
             i -= 1;
         }
     }
 
-    printTable(table, data);
+    printTable(table, data, out);
 }
 
 struct PngDirectoryHeaderInformation {
@@ -213,32 +219,32 @@ struct PngDirectoryHeaderInformation {
     uint8_t colorCount;
     uint16_t planes;
     uint16_t bitCount;
-    uint16_t bytesInRes;
-    uint16_t imageOffset;
+    uint32_t bytesInRes;
+    uint32_t imageOffset;
 };
 
 std::tuple<PngDirectoryHeaderInformation, std::vector<PrintTableColumn>>
-        printIcoDirectoryHeaderInformation(const std::vector<uint8_t> &data,
+        printIcoDirectoryHeaderInformation(const std::span<const uint8_t> data,
                 const std::size_t start, const int directoryNumber)
 {
     std::vector<PrintTableColumn> table {};
     PngDirectoryHeaderInformation pngDirectoryHeaderInformation;
     std::string imgNum = " image #" + std::to_string(directoryNumber);
-    pngDirectoryHeaderInformation.width = data.at(start + 0);
+    pngDirectoryHeaderInformation.width = readByte(data, start + 0);
     table.emplace_back(std::tuple{ start + 0, 1, "width" + imgNum, PrintTableColumnDataType::INT });
-    pngDirectoryHeaderInformation.height = data.at(start + 1);
+    pngDirectoryHeaderInformation.height = readByte(data, start + 1);
     table.emplace_back(std::tuple{ start + 1, 1, "height" + imgNum, PrintTableColumnDataType::INT });
-    pngDirectoryHeaderInformation.colorCount = data.at(start + 2);
+    pngDirectoryHeaderInformation.colorCount = readByte(data, start + 2);
     table.emplace_back(std::tuple{ start + 2, 1, "colorCount", PrintTableColumnDataType::INT });
     table.emplace_back(std::tuple{ start + 3, 1, "reserved", PrintTableColumnDataType::INT });
     pngDirectoryHeaderInformation.planes = read16BitUnsignedIntegerLE(data, start + 4);
     table.emplace_back(std::tuple{ start + 4, 2, "planes", PrintTableColumnDataType::UINT_16 });
     pngDirectoryHeaderInformation.bitCount = read16BitUnsignedIntegerLE(data, start + 6);
     table.emplace_back(std::tuple{ start + 6, 2, "bitCount", PrintTableColumnDataType::UINT_16 });
-    pngDirectoryHeaderInformation.bytesInRes = read16BitUnsignedIntegerLE(data, start + 8);
-    table.emplace_back(std::tuple{ start + 8, 2, "bytesInRes", PrintTableColumnDataType::UINT_16 });
-    pngDirectoryHeaderInformation.imageOffset = read16BitUnsignedIntegerLE(data, start + 12);
-    table.emplace_back(std::tuple{ start + 12, 2, "imageOffset", PrintTableColumnDataType::UINT_16 });
+    pngDirectoryHeaderInformation.bytesInRes = read32BitUnsignedIntegerLE(data, start + 8);
+    table.emplace_back(std::tuple{ start + 8, 4, "bytesInRes", PrintTableColumnDataType::UINT_32 });
+    pngDirectoryHeaderInformation.imageOffset = read32BitUnsignedIntegerLE(data, start + 12);
+    table.emplace_back(std::tuple{ start + 12, 4, "imageOffset", PrintTableColumnDataType::UINT_32 });
 
     return { pngDirectoryHeaderInformation, table };
 }
@@ -286,33 +292,44 @@ struct IcoInformation {
  *
  * @brief printIcoDataHeader
  * @param data
+ * @param out The output stream of the table
  */
-IcoInformation printIcoInformation(const std::vector<uint8_t> &data, const std::size_t start)
+IcoInformation printIcoInformation(const std::span<const uint8_t> data, const std::size_t start,
+                                   std::ostream &out = std::cout)
 {
+    StatisticsScopedTimer timer(StatisticsPhase::ICO_HEADER_PARSE, data.size());
     std::vector<PrintTableColumn> table {};
     IcoInformation icoInformation;
+    if (start > data.size() || data.size() - start < 6) {
+        throw std::runtime_error("Icon data is too small to contain the icon header");
+    }
     // The default header
     table.emplace_back(std::tuple{ start + 0, 2, "reserved", PrintTableColumnDataType::UINT_16 });
 
-    icoInformation.imageType = read16BitUnsignedIntegerLE(data, 2);
+    icoInformation.imageType = read16BitUnsignedIntegerLE(data, start + 2);
     table.emplace_back(std::tuple{ start + 2, 2, "imageType", PrintTableColumnDataType::UINT_16 });
-    icoInformation.imageCount = read16BitUnsignedIntegerLE(data, 4);
+    icoInformation.imageCount = read16BitUnsignedIntegerLE(data, start + 4);
     table.emplace_back(std::tuple{ start + 4, 2, "imageCount", PrintTableColumnDataType::UINT_16 });
+    // The image count is not trusted so the directory must fit into the data before it is read
+    if ((data.size() - start - 6) / 16 < icoInformation.imageCount) {
+        throw std::runtime_error("Icon data is too small to contain " + std::to_string(
+                                     icoInformation.imageCount) + " directory entries");
+    }
 
     // The directory headers
     icoInformation.directoryHeaders.resize(icoInformation.imageCount);
     for (int i = 0; i < icoInformation.imageCount; i++) {
-        const auto icoDirHeaderInformation = printIcoDirectoryHeaderInformation(data, 6 + (i * 16), i);
+        const auto icoDirHeaderInformation = printIcoDirectoryHeaderInformation(data, start + 6 + (i * 16), i);
         icoInformation.directoryHeaders.at(i) = std::get<0>(icoDirHeaderInformation);
         for (std::size_t j = 0; j < std::get<1>(icoDirHeaderInformation).size(); j++) {
             table.emplace_back(std::get<1>(icoDirHeaderInformation).at(j));
         }
     }
     for (std::size_t i = 0; i < icoInformation.directoryHeaders.size(); i++) {
-        table.emplace_back(std::tuple{ start + icoInformation.directoryHeaders.at(i).imageOffset, start + icoInformation.directoryHeaders.at(i).bytesInRes, "image data #" + std::to_string(i), PrintTableColumnDataType::HIDE });
+        table.emplace_back(std::tuple{ start + icoInformation.directoryHeaders.at(i).imageOffset, icoInformation.directoryHeaders.at(i).bytesInRes, "image data #" + std::to_string(i), PrintTableColumnDataType::HIDE });
     }
 
-    printTable(table, data);
+    printTable(table, data, out);
 
     return icoInformation;
 }
@@ -340,21 +357,21 @@ IcoInformation printIcoInformation(const std::vector<uint8_t> &data, const std::
  * - data (data is zero or more bytes of data)
  *   [The data is always padded to the nearest WORD boundary]
  */
-void printAniInformation(const std::vector<uint8_t> &data)
+void printAniInformation(const std::vector<uint8_t> &data, std::ostream &out = std::cout)
 {
     std::vector<PrintTableColumn> table {};
 
     if (12 >= data.size()) {
-        std::cout << "> No ani header found (too small)" << std::endl;
+        out << "> No ani header found (too small)" << std::endl;
         return;
     }
     if (!(data.at(0) == 'R' && data.at(1) == 'I' && data.at(2) == 'F' && data.at(3) == 'F')) {
-        std::cout << "> No ani RIFF header found (leading 4 bytes incorrect)" << std::endl;
+        out << "> No ani RIFF header found (leading 4 bytes incorrect)" << std::endl;
         return;
     }
     if (!(data.at(8) == 'A' && data.at(9) == 'C' && data.at(10) == 'O' &&
           data.at(11) == 'N')) {
-        std::cout << "> The filetype was not ACON in the header" << std::endl;
+        out << "> The filetype was not ACON in the header" << std::endl;
         return;
     }
 
@@ -362,22 +379,25 @@ void printAniInformation(const std::vector<uint8_t> &data)
     table.emplace_back(std::tuple{ i, 4, "RIFF", PrintTableColumnDataType::CHAR });
 
     i += 4;
-    const auto fileSize = read16BitUnsignedIntegerLE(data, i);
+    const auto fileSize = read32BitUnsignedIntegerLE(data, i);
     table.emplace_back(std::tuple{ i, 4, "fileSize", PrintTableColumnDataType::UINT_32 });
     i += 4;
     table.emplace_back(std::tuple{ i, 4, "ACON", PrintTableColumnDataType::CHAR });
     i += 4;
+    // The sizes are not trusted so the chunks end at the latest at the end of the data
+    const std::size_t end = std::min<std::size_t>(data.size(), static_cast<std::size_t>(fileSize) + 8);
     std::size_t chunkCounter = 0;
-    while (i < fileSize - static_cast<std::size_t>(4)) {
+    while (i + 8 <= end) {
         table.emplace_back(std::tuple{ i, 4, "chunk id #" + std::to_string(chunkCounter), PrintTableColumnDataType::CHAR });
         i += 4;
-        const auto chunkSize = read16BitUnsignedIntegerLE(data, i);
+        const std::size_t chunkSize = std::min<std::size_t>(read32BitUnsignedIntegerLE(data, i), end - i - 4);
         table.emplace_back(std::tuple{ i, 4, "chunk size #" + std::to_string(chunkCounter), PrintTableColumnDataType::UINT_32 });
         i += 4;
         table.emplace_back(std::tuple{ i, chunkSize, "chunk data #" + std::to_string(chunkCounter), PrintTableColumnDataType::HIDE });
-        i += chunkSize;
+        // The chunk data is always padded to the nearest WORD boundary
+        i += chunkSize + (chunkSize % 2);
         chunkCounter += 1;
     }
 
-    printTable(table, data);
+    printTable(table, data, out);
 }
@@ -11,24 +11,67 @@ cmake -S . -B build_cmake "$@"
 cmake --build build_cmake
 
 ./build_cmake/aniFileExtractor test/test.ani test/out_test_images
+./build_cmake/aniFileExtractor --threads=1 test/test.ani test/out_test_images
+./build_cmake/aniFileExtractor xcursor test/test.ani test/out_test_cursor
+./build_cmake/aniFileExtractor apng test/test.ani test/out_test_preview.png
+./build_cmake/aniFileExtractor --quantize apng test/test.ani test/out_test_preview_quantized.png
+./build_cmake/aniFileExtractor create test/out_test.ani 10 test/out_test_images/test_0.ico test/out_test_images/test_1.ico test/test.png
+./build_cmake/aniFileExtractor ani test/out_test.ani
 ./build_cmake/aniFileExtractor ani test/test.ani
+./build_cmake/aniFileExtractor rewrite test/test.ani test/out_test_rewritten.ani
+cmp test/test.ani test/out_test_rewritten.ani
+./build_cmake/aniFileExtractor dump test/test.ani anih "seq " "#2" 0-12
+./build_cmake/aniFileExtractor --stats test/test.ani test/out_test_images
+./build_cmake/aniFileExtractor --stats=json xcursor test/test.ani test/out_test_cursor
+./build_cmake/aniFileExtractor --stats=json=test/out_test_stats.json xcursor test/test.ani test/out_test_cursor
 ./build_cmake/aniFileExtractor png test/test.png
 ./build_cmake/aniFileExtractor ico test/test.ico
 
+# Build the fuzz targets with the standalone driver and run them on the test files
+cmake -S . -B build_fuzz -DBUILD_FUZZERS=ON -DCMAKE_CXX_COMPILER=g++ "$@"
+cmake --build build_fuzz --target fuzzAniParser fuzzIcoParser fuzzPngParser fuzzRiffChunkParser fuzzApngWriter fuzzX11CursorWriter
+./build_fuzz/fuzzAniParser test/test.ani
+./build_fuzz/fuzzIcoParser test/test.ico
+./build_fuzz/fuzzPngParser test/test.png
+./build_fuzz/fuzzRiffChunkParser test/test.ani
+./build_fuzz/fuzzApngWriter test/test.ani
+./build_fuzz/fuzzX11CursorWriter test/test.ani
+# The test files are scaled up (more frames/steps/images/chunks) and a flagged target stops the script
+./build_fuzz/fuzzAniParser --timing test/test.ani
+./build_fuzz/fuzzIcoParser --timing test/test.ico
+./build_fuzz/fuzzPngParser --timing test/test.png
+./build_fuzz/fuzzRiffChunkParser --timing test/test.ani
+./build_fuzz/fuzzApngWriter --timing test/test.ani
+./build_fuzz/fuzzX11CursorWriter --timing test/test.ani
+
 # Build the executable with gcc
 mkdir -p build_gcc
-g++ aniFileExtractor.cpp -I ./ -std=c++23 -o build_gcc/aniFileExtractor
+g++ aniFileExtractor.cpp -I ./ -std=c++23 -pthread -DANI_FILE_EXTRACTOR_VERIFY_SIMD=1 -o build_gcc/aniFileExtractor
 
 ./build_gcc/aniFileExtractor test/test.ani test/out_test_images
+./build_gcc/aniFileExtractor xcursor test/test.ani test/out_test_cursor
+./build_gcc/aniFileExtractor apng test/test.ani test/out_test_preview.png
+./build_gcc/aniFileExtractor create test/out_test.ani 10 test/out_test_images/test_0.ico test/out_test_images/test_1.ico test/test.png
+./build_gcc/aniFileExtractor ani test/out_test.ani
 ./build_gcc/aniFileExtractor ani test/test.ani
+./build_gcc/aniFileExtractor rewrite test/test.ani test/out_test_rewritten.ani
+cmp test/test.ani test/out_test_rewritten.ani
+./build_gcc/aniFileExtractor dump test/test.ani anih "seq " "#2" 0-12
 ./build_gcc/aniFileExtractor png test/test.png
 ./build_gcc/aniFileExtractor ico test/test.ico
 
 # Build the executable with clang
 mkdir -p build_clang
-clang++ aniFileExtractor.cpp -I ./ -std=c++20 -o build_clang/aniFileExtractor
+clang++ aniFileExtractor.cpp -I ./ -std=c++20 -pthread -o build_clang/aniFileExtractor
 
 ./build_clang/aniFileExtractor test/test.ani test/out_test_images
+./build_clang/aniFileExtractor xcursor test/test.ani test/out_test_cursor
+./build_clang/aniFileExtractor apng test/test.ani test/out_test_preview.png
+./build_clang/aniFileExtractor create test/out_test.ani 10 test/out_test_images/test_0.ico test/out_test_images/test_1.ico test/test.png
+./build_clang/aniFileExtractor ani test/out_test.ani
 ./build_clang/aniFileExtractor ani test/test.ani
+./build_clang/aniFileExtractor rewrite test/test.ani test/out_test_rewritten.ani
+cmp test/test.ani test/out_test_rewritten.ani
+./build_clang/aniFileExtractor dump test/test.ani anih "seq " "#2" 0-12
 ./build_clang/aniFileExtractor png test/test.png
 ./build_clang/aniFileExtractor ico test/test.ico
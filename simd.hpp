@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * Vectorized code paths are only compiled for x86 CPUs and compilers that support selecting the
+ * instruction set per function (GCC, Clang).
+ * This way the executable can be compiled without any `-march` flags and the best supported
+ * instruction set is selected at runtime while other platforms use the scalar code paths.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ANI_FILE_EXTRACTOR_X86_SIMD 1
+#include <immintrin.h>
+#define ANI_FILE_EXTRACTOR_TARGET(instructionSet) __attribute__((target(instructionSet)))
+#else
+#define ANI_FILE_EXTRACTOR_X86_SIMD 0
+#define ANI_FILE_EXTRACTOR_TARGET(instructionSet)
+#endif
+
+/**
+ * Compare the results of the vectorized code paths with the scalar reference implementations
+ * (opt-in with -DANI_FILE_EXTRACTOR_VERIFY_SIMD=1 since every conversion is then done twice)
+ */
+#ifndef ANI_FILE_EXTRACTOR_VERIFY_SIMD
+#define ANI_FILE_EXTRACTOR_VERIFY_SIMD 0
+#endif
+constexpr bool verifySimd = ANI_FILE_EXTRACTOR_VERIFY_SIMD;
+
+/**
+ * @brief Check if the CPU supports AVX2 instructions
+ */
+bool cpuSupportsAvx2()
+{
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Check if the CPU supports SSSE3 instructions
+ */
+bool cpuSupportsSsse3()
+{
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Check if the CPU supports SSE4.1 instructions
+ */
+bool cpuSupportsSse41()
+{
+#if ANI_FILE_EXTRACTOR_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+
+/**
+ * Collect statistics (can be disabled at compile time with -DANI_FILE_EXTRACTOR_STATISTICS=0 which
+ * removes all timers and counters)
+ */
+#ifndef ANI_FILE_EXTRACTOR_STATISTICS
+#define ANI_FILE_EXTRACTOR_STATISTICS 1
+#endif
+constexpr bool collectStatistics = ANI_FILE_EXTRACTOR_STATISTICS;
+
+/**
+ * The phases of a run that are measured.
+ * The chunk handling is part of the RIFF scan so its time is contained in both.
+ */
+enum class StatisticsPhase {
+    READ, RIFF_SCAN, CHUNK_HANDLING, ICO_HEADER_PARSE, FRAME_WRITE, TEMPLATE_WRITE, COUNT
+};
+
+/**
+ * @brief Get the name of a statistics phase
+ */
+std::string statisticsPhaseToStr(const StatisticsPhase phase)
+{
+    switch (phase) {
+        case StatisticsPhase::READ:
+            return "read";
+        case StatisticsPhase::RIFF_SCAN:
+            return "riff scan";
+        case StatisticsPhase::CHUNK_HANDLING:
+            return "chunk handling";
+        case StatisticsPhase::ICO_HEADER_PARSE:
+            return "ico header parse";
+        case StatisticsPhase::FRAME_WRITE:
+            return "frame write";
+        case StatisticsPhase::TEMPLATE_WRITE:
+            return "template write";
+        default:
+            return "unknown";
+    }
+}
+
+struct PhaseStatistics {
+    /** How often the phase was run */
+    uint64_t calls = 0;
+    /** The summed up wall-clock time of all runs */
+    std::chrono::nanoseconds duration = {};
+    /** The number of processed bytes */
+    uint64_t bytes = 0;
+    /** The number of heap allocations */
+    uint64_t allocations = 0;
+};
+
+struct ChunkStatistics {
+    /** How often a chunk type was found */
+    uint64_t count = 0;
+    /** The summed up data length of all chunks of this type */
+    uint64_t bytes = 0;
+};
+
+/**
+ * Collection of all statistics of a run
+ * (phases that run on multiple threads sum up the time of all threads and the allocations of a phase
+ * also contain the allocations of other threads that happened at the same time)
+ */
+struct Statistics {
+    /** Statistics are only collected if this is enabled (--stats, is set before any thread is started) */
+    bool enabled = false;
+    /** Protects the phases and chunks when they are updated from multiple threads */
+    std::mutex mutex = {};
+    /** The statistics of each phase */
+    std::array<PhaseStatistics, static_cast<std::size_t>(StatisticsPhase::COUNT)> phases = {};
+    /** The statistics of each RIFF chunk type (FOURCC) */
+    std::map<std::string, ChunkStatistics> chunks = {};
+};
+
+/**
+ * @brief Get the global statistics of this run
+ */
+Statistics &getStatistics()
+{
+    static Statistics statistics {};
+    return statistics;
+}
+
+/**
+ * The number of heap allocations of this program
+ */
+std::atomic<uint64_t> statisticsAllocationCounter = 0;
+
+#if ANI_FILE_EXTRACTOR_STATISTICS
+/**
+ * Allocation function of all replaced global allocation functions.
+ * The allocation and deallocation functions are never inlined so the compiler does not pair the
+ * malloc/free calls with the new/delete expressions of the callers (-Wmismatched-new-delete).
+ */
+[[gnu::noinline]] void *statisticsAllocate(const std::size_t size, const std::size_t alignment)
+{
+    // Runs without --stats do not pay for the shared atomic counter
+    if (getStatistics().enabled) {
+        statisticsAllocationCounter.fetch_add(1, std::memory_order_relaxed);
+    }
+    const std::size_t allocationSize = size == 0 ? 1 : size;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(allocationSize);
+    }
+    // The size of aligned allocations must be a multiple of the alignment
+    return std::aligned_alloc(alignment, (allocationSize + alignment - 1) / alignment * alignment);
+}
+
+/**
+ * Deallocation function of all replaced global deallocation functions
+ */
+[[gnu::noinline]] void statisticsDeallocate(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+/**
+ * @brief Allocate memory for the replaced global allocation functions (throws if it fails)
+ */
+void *statisticsAllocateOrThrow(const std::size_t size, const std::size_t alignment)
+{
+    if (void *pointer = statisticsAllocate(size, alignment)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// Count the heap allocations by replacing all global allocation and deallocation functions
+[[gnu::noinline]] void *operator new (std::size_t size)
+{
+    return statisticsAllocateOrThrow(size, alignof(std::max_align_t));
+}
+[[gnu::noinline]] void *operator new[](std::size_t size)
+{
+    return statisticsAllocateOrThrow(size, alignof(std::max_align_t));
+}
+[[gnu::noinline]] void *operator new (std::size_t size, std::align_val_t alignment)
+{
+    return statisticsAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+[[gnu::noinline]] void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return statisticsAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+[[gnu::noinline]] void *operator new (std::size_t size, const std::nothrow_t &) noexcept
+{
+    return statisticsAllocate(size, alignof(std::max_align_t));
+}
+[[gnu::noinline]] void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return statisticsAllocate(size, alignof(std::max_align_t));
+}
+[[gnu::noinline]] void *operator new (std::size_t size, std::align_val_t alignment,
+                                      const std::nothrow_t &) noexcept
+{
+    return statisticsAllocate(size, static_cast<std::size_t>(alignment));
+}
+[[gnu::noinline]] void *operator new[](std::size_t size, std::align_val_t alignment,
+                                       const std::nothrow_t &) noexcept
+{
+    return statisticsAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+[[gnu::noinline]] void operator delete (void *pointer) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete[](void *pointer) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete (void *pointer, std::size_t) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete[](void *pointer, std::size_t) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete (void *pointer, std::align_val_t) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete[](void *pointer, std::align_val_t) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete (void *pointer, std::size_t, std::align_val_t) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete (void *pointer, const std::nothrow_t &) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete (void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+[[gnu::noinline]] void operator delete[](void *pointer, std::align_val_t,
+                                         const std::nothrow_t &) noexcept
+{
+    statisticsDeallocate(pointer);
+}
+#endif
+
+/**
+ * Measures the wall-clock time and heap allocations between its creation and destruction and adds
+ * them to a phase of the global statistics.
+ * The time and allocations between pause() and resume() are not counted.
+ */
+class StatisticsScopedTimer
+{
+public:
+    explicit StatisticsScopedTimer(const StatisticsPhase phase, const std::size_t bytes = 0)
+        : phase(phase), bytes(bytes)
+    {
+        if constexpr(collectStatistics) {
+            if (getStatistics().enabled) {
+                allocationsStart = statisticsAllocationCounter.load(std::memory_order_relaxed);
+                start = std::chrono::steady_clock::now();
+            }
+        }
+    }
+    ~StatisticsScopedTimer()
+    {
+        if constexpr(collectStatistics) {
+            if (getStatistics().enabled) {
+                const auto duration = std::chrono::steady_clock::now() - start - pausedDuration;
+                const auto allocations = statisticsAllocationCounter.load(std::memory_order_relaxed) -
+                                         allocationsStart - pausedAllocations;
+                const std::lock_guard<std::mutex> lock(getStatistics().mutex);
+                auto &phaseStatistics = getStatistics().phases.at(static_cast<std::size_t>(phase));
+                phaseStatistics.calls += 1;
+                phaseStatistics.duration += duration;
+                phaseStatistics.bytes += bytes;
+                phaseStatistics.allocations += allocations;
+            }
+        }
+    }
+    StatisticsScopedTimer(const StatisticsScopedTimer &) = delete;
+    StatisticsScopedTimer &operator=(const StatisticsScopedTimer &) = delete;
+
+    void pause()
+    {
+        if constexpr(collectStatistics) {
+            if (getStatistics().enabled) {
+                pauseAllocationsStart = statisticsAllocationCounter.load(std::memory_order_relaxed);
+                pauseStart = std::chrono::steady_clock::now();
+            }
+        }
+    }
+    void resume()
+    {
+        if constexpr(collectStatistics) {
+            if (getStatistics().enabled) {
+                pausedDuration += std::chrono::steady_clock::now() - pauseStart;
+                pausedAllocations += statisticsAllocationCounter.load(std::memory_order_relaxed) -
+                                     pauseAllocationsStart;
+            }
+        }
+    }
+
+private:
+    const StatisticsPhase phase;
+    const std::size_t bytes;
+    uint64_t allocationsStart = 0;
+    std::chrono::steady_clock::time_point start = {};
+    uint64_t pauseAllocationsStart = 0;
+    std::chrono::steady_clock::time_point pauseStart = {};
+    uint64_t pausedAllocations = 0;
+    std::chrono::steady_clock::duration pausedDuration = {};
+};
+
+/**
+ * Pauses a timer from its creation until its destruction (for example while a callback runs whose
+ * time belongs to another phase)
+ */
+class StatisticsTimerPause
+{
+public:
+    explicit StatisticsTimerPause(StatisticsScopedTimer &timer) : timer(timer)
+    {
+        timer.pause();
+    }
+    ~StatisticsTimerPause()
+    {
+        timer.resume();
+    }
+    StatisticsTimerPause(const StatisticsTimerPause &) = delete;
+    StatisticsTimerPause &operator=(const StatisticsTimerPause &) = delete;
+
+private:
+    StatisticsScopedTimer &timer;
+};
+
+/**
+ * @brief Count a found RIFF chunk
+ * @param chunkId The FOURCC of the chunk
+ * @param length The data length of the chunk
+ */
+void countStatisticsChunk(const std::string &chunkId, const std::size_t length)
+{
+    if constexpr(collectStatistics) {
+        if (getStatistics().enabled) {
+            const std::lock_guard<std::mutex> lock(getStatistics().mutex);
+            auto &chunkStatistics = getStatistics().chunks[chunkId];
+            chunkStatistics.count += 1;
+            chunkStatistics.bytes += length;
+        }
+    }
+}
+
+/**
+ * @brief Print a summary of the global statistics
+ */
+void printStatistics(std::ostream &out)
+{
+    if constexpr(!collectStatistics) {
+        out << "> Statistics were disabled at compile time" << std::endl;
+        return;
+    }
+    const auto &statistics = getStatistics();
+    const auto outFlags = out.flags();
+    out << "| " << std::left << std::setw(16) << "Phase" << " | " << std::setw(6) << "Calls"
+        << " | " << std::setw(12) << "Time (ms)" << " | " << std::setw(12) << "Bytes"
+        << " | " << std::setw(11) << "Allocations" << " |\n";
+    out << "| " << std::string(16, '-') << " | " << std::string(6, '-') << " | " << std::string(12, '-')
+        << " | " << std::string(12, '-') << " | " << std::string(11, '-') << " |\n";
+    for (std::size_t i = 0; i < statistics.phases.size(); i++) {
+        const auto &phase = statistics.phases.at(i);
+        out << "| " << std::setw(16) << statisticsPhaseToStr(static_cast<StatisticsPhase>(i))
+            << " | " << std::setw(6) << phase.calls
+            << " | " << std::setw(12) << std::fixed << std::setprecision(3)
+            << std::chrono::duration<double, std::milli>(phase.duration).count()
+            << " | " << std::setw(12) << phase.bytes << " | " << std::setw(11) << phase.allocations << " |\n";
+    }
+    out << "\n| " << std::setw(8) << "Chunk" << " | " << std::setw(6) << "Count" << " | " << std::setw(12)
+        << "Bytes" << " |\n";
+    out << "| " << std::string(8, '-') << " | " << std::string(6, '-') << " | " << std::string(12, '-') << " |\n";
+    for (const auto &[chunkId, chunk] : statistics.chunks) {
+        out << "| " << std::setw(8) << ("'" + chunkId + "'") << " | " << std::setw(6) << chunk.count << " | "
+            << std::setw(12) << chunk.bytes << " |\n";
+    }
+    out << "\nTotal allocations: " << statisticsAllocationCounter.load() << std::endl;
+    out.flags(outFlags);
+}
+
+/**
+ * @brief Print the global statistics as JSON object
+ */
+void printStatisticsJson(std::ostream &out)
+{
+    if constexpr(!collectStatistics) {
+        out << "{\"enabled\":false}" << std::endl;
+        return;
+    }
+    const auto &statistics = getStatistics();
+    out << "{\"enabled\":true,\"phases\":{";
+    for (std::size_t i = 0; i < statistics.phases.size(); i++) {
+        const auto &phase = statistics.phases.at(i);
+        out << (i > 0 ? "," : "") << "\"" << statisticsPhaseToStr(static_cast<StatisticsPhase>(i))
+            << "\":{\"calls\":" << phase.calls << ",\"nanoseconds\":" << phase.duration.count()
+            << ",\"bytes\":" << phase.bytes << ",\"allocations\":" << phase.allocations << "}";
+    }
+    out << "},\"chunks\":{";
+    bool first = true;
+    for (const auto &[chunkId, chunk] : statistics.chunks) {
+        out << (first ? "" : ",") << "\"" << chunkId << "\":{\"count\":" << chunk.count
+            << ",\"bytes\":" << chunk.bytes << "}";
+        first = false;
+    }
+    out << "},\"allocations\":" << statisticsAllocationCounter.load() << "}" << std::endl;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#include "aniFileExtractor.hpp"
+#include "icoImageDecoder.hpp"
+#include "premultiplyArgb.hpp"
+
+/** The maximum number of different delays with which a single image is written */
+constexpr std::size_t x11CursorMaxDelaysPerImage = 64;
+
+/**
+ * Sources:
+ * - https://www.x.org/releases/current/doc/man/man3/Xcursor.3.xhtml
+ *
+ * All values in Xcursor files are represented in little-endian byte order.
+ *
+ * Header:
+ *   > "Xcur" (magic)
+ *   > {4 Bytes=CARD32=header} (bytes in the header = 16)
+ *   > {4 Bytes=CARD32=version} (file version = 0x10000)
+ *   > {4 Bytes=CARD32=ntoc} (number of table of contents entries)
+ * Table of contents entry:
+ *   > {4 Bytes=CARD32=type} (0xfffd0002 for images)
+ *   > {4 Bytes=CARD32=subtype} (nominal size of the image)
+ *   > {4 Bytes=CARD32=position} (absolute byte position of the chunk in the file)
+ * Image chunk:
+ *   > {4 Bytes=CARD32=header} (bytes in the chunk header = 36)
+ *   > {4 Bytes=CARD32=type} (0xfffd0002)
+ *   > {4 Bytes=CARD32=subtype} (nominal size of the image)
+ *   > {4 Bytes=CARD32=version} (1)
+ *   > {4 Bytes=CARD32=width}
+ *   > {4 Bytes=CARD32=height}
+ *   > {4 Bytes=CARD32=xhot}
+ *   > {4 Bytes=CARD32=yhot}
+ *   > {4 Bytes=CARD32=delay} (milliseconds until the next image of the animation)
+ *   > {width * height * 4 Bytes=ARGB32=pixels} (premultiplied alpha, row by row from the top)
+ *
+ * The size of the file is calculated before writing so that the pixels can be converted directly
+ * into their final position without any intermediate image format.
+ * Every animation step has its own table of contents entry, but steps that show the same image with
+ * the same delay point to the same image chunk, so a long 'seq ' chunk does not repeat the pixels.
+ * An image can be used with at most x11CursorMaxDelaysPerImage different delays (this limits the
+ * output to a multiple of the decoded pixels).
+ *
+ * @brief Create the binary data of an (animated) X11 cursor file
+ * @param images The decoded images of the cursor
+ * @param steps The animation steps that reference the images
+ * @return The Xcursor file binary data vector
+ */
+std::vector<uint8_t> createX11CursorFile(const std::vector<RgbaImage> &images,
+        const std::vector<AniAnimationStep> &steps)
+{
+    constexpr uint32_t imageType = 0xfffd0002;
+    constexpr std::size_t fileHeaderSize = 16;
+    constexpr std::size_t tocEntrySize = 12;
+    constexpr std::size_t imageHeaderSize = 36;
+
+    // Assign an image chunk to every distinct (image, delay) pair in the order of the first use
+    std::map<std::pair<std::size_t, uint32_t>, std::size_t> chunkPositions {};
+    std::vector<std::size_t> delaysPerImage(images.size());
+    std::vector<AniAnimationStep> chunks {};
+    std::size_t fileSize = fileHeaderSize + steps.size() * tocEntrySize;
+    for (const auto &step : steps) {
+        const auto &image = images.at(step.iconIndex);
+        if (!chunkPositions.emplace(std::pair{ step.iconIndex, step.jiffies }, fileSize).second) {
+            continue;
+        }
+        if (++delaysPerImage.at(step.iconIndex) > x11CursorMaxDelaysPerImage) {
+            throw std::runtime_error("Icon " + std::to_string(step.iconIndex) + " is used with more than " +
+                                     std::to_string(x11CursorMaxDelaysPerImage) + " different delays");
+        }
+        chunks.push_back(step);
+        fileSize += imageHeaderSize + static_cast<std::size_t>(image.width) * image.height * 4;
+    }
+    std::vector<uint8_t> data(fileSize);
+
+    data.at(0) = 'X';
+    data.at(1) = 'c';
+    data.at(2) = 'u';
+    data.at(3) = 'r';
+    write32BitUnsignedIntegerLE(data, 4, fileHeaderSize);
+    write32BitUnsignedIntegerLE(data, 8, 0x10000);
+    write32BitUnsignedIntegerLE(data, 12, static_cast<uint32_t>(steps.size()));
+
+    for (std::size_t i = 0; i < steps.size(); i++) {
+        const auto &image = images.at(steps.at(i).iconIndex);
+        const std::size_t tocEntry = fileHeaderSize + i * tocEntrySize;
+        write32BitUnsignedIntegerLE(data, tocEntry, imageType);
+        write32BitUnsignedIntegerLE(data, tocEntry + 4, image.width);
+        write32BitUnsignedIntegerLE(data, tocEntry + 8, static_cast<uint32_t>(chunkPositions.at(std::pair{
+            steps.at(i).iconIndex, steps.at(i).jiffies })));
+    }
+    for (const auto &chunk : chunks) {
+        const auto &image = images.at(chunk.iconIndex);
+        std::size_t position = chunkPositions.at(std::pair{ chunk.iconIndex, chunk.jiffies });
+        write32BitUnsignedIntegerLE(data, position, imageHeaderSize);
+        write32BitUnsignedIntegerLE(data, position + 4, imageType);
+        write32BitUnsignedIntegerLE(data, position + 8, image.width);
+        write32BitUnsignedIntegerLE(data, position + 12, 1);
+        write32BitUnsignedIntegerLE(data, position + 16, image.width);
+        write32BitUnsignedIntegerLE(data, position + 20, image.height);
+        write32BitUnsignedIntegerLE(data, position + 24, std::min(image.xHotspot, image.width));
+        write32BitUnsignedIntegerLE(data, position + 28, std::min(image.yHotspot, image.height));
+        // Jiffies are 1/60th of a second
+        write32BitUnsignedIntegerLE(data, position + 32,
+                                    static_cast<uint32_t>(static_cast<uint64_t>(chunk.jiffies) * 1000 / 60));
+        position += imageHeaderSize;
+
+        const std::size_t pixelCount = static_cast<std::size_t>(image.width) * image.height;
+        premultiplyRgbaToArgb(image.pixels.data(), data.data() + position, pixelCount);
+    }
+    return data;
+}
+
+/**
+ * @brief Convert the icons of a `.ani` file to an (animated) X11 cursor file
+ * @param aniFileInformation The read `.ani` file information
+ * @return The Xcursor file binary data vector
+ */
+std::vector<uint8_t> convertAniToX11Cursor(const AniFileInformation &aniFileInformation)
+{
+    std::vector<RgbaImage> images {};
+    images.reserve(aniFileInformation.icons.size());
+    for (const auto &icon : aniFileInformation.icons) {
+        images.push_back(decodeIcoImage(icon));
+    }
+    return createX11CursorFile(images, getAniAnimationSteps(aniFileInformation));
+}